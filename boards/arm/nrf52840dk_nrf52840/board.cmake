@@ -2,4 +2,13 @@
 
 if(${CMAKE_BUILD_TYPE} STREQUAL "Debug")
     list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/conf/debug_uart.conf)
-endif()
\ No newline at end of file
+else()
+    list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/conf/release_uart.conf)
+endif()
+
+# Stack sizes measured on the board, written by `make footprint STACK_CONF=...`
+if(EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/nrf52840dk_nrf52840/stacks.conf)
+    list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/nrf52840dk_nrf52840/stacks.conf)
+endif()
+
+list(APPEND DTC_OVERLAY_FILE ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/nrf52840dk_nrf52840/nrf52840dk_nrf52840.overlay)
@@ -2,6 +2,13 @@
 
 if(${CMAKE_BUILD_TYPE} STREQUAL "Debug")
     list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/conf/debug_rtt.conf)
+else()
+    list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/conf/release_rtt.conf)
 endif()
 
-# list(APPEND DTC_OVERLAY_FILE ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/thingy52_nrf52832/thingy52_nrf52832.overlay)
\ No newline at end of file
+# Stack sizes measured on the board, written by `make footprint STACK_CONF=...`
+if(EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/thingy52_nrf52832/stacks.conf)
+    list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/thingy52_nrf52832/stacks.conf)
+endif()
+
+list(APPEND DTC_OVERLAY_FILE ${CMAKE_CURRENT_SOURCE_DIR}/boards/arm/thingy52_nrf52832/thingy52_nrf52832.overlay)
@@ -0,0 +1,5 @@
+# native_sim is supported by default in Zephyr. The HTS221 is replaced by the emulator in src/hts221/emul.
+
+list(APPEND CONF_FILE ${CMAKE_CURRENT_SOURCE_DIR}/conf/native_sim.conf)
+
+list(APPEND DTC_OVERLAY_FILE ${CMAKE_CURRENT_SOURCE_DIR}/boards/posix/native_sim/native_sim.overlay)
@@ -10,6 +10,9 @@ if (BOARD STREQUAL "thingy52_nrf52832")
 elseif(BOARD STREQUAL "nrf52840dk_nrf52840")
     message(NOTICE "Select BOARD nRF52840DK")
     include(boards/arm/nrf52840dk_nrf52840/board.cmake)
+elseif(BOARD STREQUAL "native_sim")
+    message(NOTICE "Select BOARD native_sim")
+    include(boards/posix/native_sim/board.cmake)
 else()
     message(FATAL_ERROR "Selected board is not supported. Add your board to boards/CMakeLists.txt")
 endif()
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Summarizes the RAM/ROM footprint of a build and the stack high-water marks of its threads.
+
+The RAM and ROM reports are the outputs of the `ram_report` and `rom_report` build targets. The thread log is the log
+of a build with conf/profile.conf (thread analyzer), captured while the application runs. With --write-conf, the
+suggested stack sizes are written as a Kconfig fragment, which the board picks up as its stacks.conf.
+"""
+
+import argparse
+import re
+import sys
+
+# Thread name in the thread analyzer report -> Kconfig option of its stack size
+STACK_OPTIONS = {
+    "hts221_thread_id": "CONFIG_HTS221_THREAD_STACK_SIZE",
+    "sample_log_thread_id": "CONFIG_SAMPLE_LOG_THREAD_STACK_SIZE",
+    "bench_thread_id": "CONFIG_BENCH_THREAD_STACK_SIZE",
+    "main": "CONFIG_MAIN_STACK_SIZE",
+    "idle": "CONFIG_IDLE_STACK_SIZE",
+    "sysworkq": "CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE",
+    "logging": "CONFIG_LOG_PROCESS_THREAD_STACK_SIZE",
+    "shell_uart": "CONFIG_SHELL_STACK_SIZE",
+    "shell_rtt": "CONFIG_SHELL_STACK_SIZE",
+    "ISR0": "CONFIG_ISR_STACK_SIZE",
+}
+
+STACK_MARGIN = 1.25  # suggested size = high-water mark + 25 %, rounded up to STACK_ALIGN
+STACK_ALIGN = 64
+
+REPORT_LINE = re.compile(r"^(?P<tree>[\s│├└─]*)(?P<name>\S.*?)\s+(?P<size>\d+)\s+(?P<percent>[\d.]+)%$")
+THREAD_LINE = re.compile(
+    r"(?P<name>[\w.-]+)\s*:\s*STACK: unused (?P<unused>\d+) usage (?P<usage>\d+) / (?P<size>\d+) \((?P<percent>\d+) %\)"
+)
+
+
+def parse_report(path):
+    """Returns the (depth, name, size) entries of a ram_report/rom_report output, Root first."""
+    entries = []
+    with open(path, encoding="utf-8") as report:
+        for line in report:
+            match = REPORT_LINE.match(line.rstrip())
+            if match is None:
+                continue
+            depth = len(match["tree"]) // 4
+            entries.append((depth, match["name"], int(match["size"])))
+    return entries
+
+
+def print_report(title, entries, depth, top):
+    if not entries:
+        print(f"{title}: no entries found")
+        return
+
+    total = entries[0][2]
+    print(f"{title}: {total} bytes")
+    for entry_depth, name, size in entries[1:]:
+        if entry_depth <= depth and size > 0:
+            print(f"  {'  ' * (entry_depth - 1)}{name:<{48 - 2 * entry_depth}} {size:>8} {100 * size / total:6.2f} %")
+
+    # Leaves are the symbols: an entry is a leaf when the next one is not deeper
+    symbols = [
+        (size, name)
+        for i, (entry_depth, name, size) in enumerate(entries)
+        if i + 1 == len(entries) or entries[i + 1][0] <= entry_depth
+    ]
+    print("  largest symbols:")
+    for size, name in sorted(symbols, reverse=True)[:top]:
+        print(f"    {name:<46} {size:>8}")
+    print()
+
+
+def parse_threads(path):
+    """Returns {thread name: (stack size, maximum usage)} over all the thread analyzer reports of a log."""
+    threads = {}
+    with open(path, encoding="utf-8", errors="replace") as log:
+        for line in log:
+            match = THREAD_LINE.search(line)
+            if match is None:
+                continue
+            name, size, usage = match["name"], int(match["size"]), int(match["usage"])
+            previous = threads.get(name, (size, 0))
+            threads[name] = (size, max(previous[1], usage))
+    return threads
+
+
+def suggested_size(usage):
+    return -(-int(usage * STACK_MARGIN) // STACK_ALIGN) * STACK_ALIGN
+
+
+def print_threads(threads):
+    if not threads:
+        print("Threads: no thread analyzer report found")
+        return
+
+    print("Threads:")
+    print(f"  {'thread':<24} {'size':>6} {'usage':>6} {'%':>4}  suggested")
+    total_size, total_suggested = 0, 0
+    for name, (size, usage) in sorted(threads.items()):
+        suggested = suggested_size(usage)
+        option = STACK_OPTIONS.get(name)
+        suggestion = f"{option}={suggested}" if option else str(suggested)
+        print(f"  {name:<24} {size:>6} {usage:>6} {100 * usage // size:>3}%  {suggestion}")
+        total_size += size
+        total_suggested += suggested
+    print(f"  stacks: {total_size} bytes, {total_suggested} bytes with the suggested sizes")
+
+
+def write_conf(path, threads, log):
+    """Writes the suggested sizes of the threads that have a stack size option, with the measured peaks."""
+    sizes = {}
+    for name, (size, usage) in sorted(threads.items()):
+        option = STACK_OPTIONS.get(name)
+        if option is None:
+            continue
+        # Threads sharing an option (shell backends) get the largest suggestion
+        if option not in sizes or suggested_size(usage) > sizes[option][0]:
+            sizes[option] = (suggested_size(usage), name, usage, size)
+
+    with open(path, "w", encoding="utf-8") as conf:
+        conf.write(f"# Generated by scripts/footprint.py from {log}\n")
+        conf.write(f"# Thread analyzer peak + {round(100 * (STACK_MARGIN - 1))} %, rounded up to {STACK_ALIGN} bytes\n")
+        for option, (suggested, name, usage, size) in sorted(sizes.items()):
+            conf.write(f"\n# {name}: peak {usage} of {size} bytes\n{option}={suggested}\n")
+    print(f"  written to {path}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("ram_report", help="output of the ram_report target")
+    parser.add_argument("rom_report", help="output of the rom_report target")
+    parser.add_argument("--threads", help="log of a profile build, with thread analyzer reports")
+    parser.add_argument("--write-conf", help="Kconfig fragment to write the suggested stack sizes to (needs --threads)")
+    parser.add_argument("--depth", type=int, default=2, help="depth of the report tree to print (default 2)")
+    parser.add_argument("--top", type=int, default=15, help="number of largest symbols to print (default 15)")
+    args = parser.parse_args()
+
+    print_report("RAM", parse_report(args.ram_report), args.depth, args.top)
+    print_report("ROM", parse_report(args.rom_report), args.depth, args.top)
+    if args.threads:
+        threads = parse_threads(args.threads)
+        print_threads(threads)
+        if args.write_conf and threads:
+            write_conf(args.write_conf, threads, args.threads)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
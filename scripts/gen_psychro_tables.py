@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""Generates the lookup tables of src/psychro: logarithm, Magnus exponent and saturation absolute humidity.
+
+Dew point and absolute humidity use the Magnus formula over water (Sonntag 1990 coefficients):
+    es(T) = 6.112 hPa * exp(b * T / (c + T))
+    Td = c * g / (b - g), with g = ln(RH / 100) + b * T / (c + T)
+    AH = RH / 100 * 216.7 * es(T) / (273.15 + T)  [g/m^3, es in hPa]
+The firmware only interpolates the tables, so it needs neither logf() nor expf().
+"""
+
+import argparse
+import math
+import sys
+
+MAGNUS_A_HPA = 6.112
+MAGNUS_B = 17.62
+MAGNUS_C_DEGC = 243.12
+AH_FACTOR = 216.7  # g K / (m^3 hPa)
+
+LN_TABLE_BITS = 6  # ln(1 + i / 2^LN_TABLE_BITS) for the mantissa of the logarithm
+T_MIN_MILLI = -40000  # HTS221 operating range
+T_MAX_MILLI = 120000
+T_STEP_SHIFT = 10  # 1.024 degC steps: the firmware interpolates with shifts only
+AH_UNIT_SHIFT = 10  # absolute humidity in 2^-10 mg/m^3
+
+
+def magnus_exponent(t_degc):
+    """b * T / (c + T), the exponent of the Magnus formula."""
+    return MAGNUS_B * t_degc / (MAGNUS_C_DEGC + t_degc)
+
+
+def saturation_abs_humidity(t_degc):
+    """Absolute humidity of saturated air at t_degc, in g/m^3."""
+    es_hpa = MAGNUS_A_HPA * math.exp(magnus_exponent(t_degc))
+    return AH_FACTOR * es_hpa / (273.15 + t_degc)
+
+
+def table(c_type, name, values, per_line=8):
+    lines = [f"static const {c_type} {name}[{len(values)}] = {{"]
+    for i in range(0, len(values), per_line):
+        lines.append("    " + " ".join(f"{v}," for v in values[i : i + per_line]))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def generate():
+    ln_table = [round(math.log(1 + i / (1 << LN_TABLE_BITS)) * 65536) for i in range((1 << LN_TABLE_BITS) + 1)]
+
+    # One more entry past T_MAX_MILLI, so that the interpolation never reads out of the tables
+    t_count = ((T_MAX_MILLI - T_MIN_MILLI) >> T_STEP_SHIFT) + 2
+    t_grid = [(T_MIN_MILLI + (i << T_STEP_SHIFT)) / 1000 for i in range(t_count)]
+    magnus_table = [round(magnus_exponent(t) * 65536) for t in t_grid]
+    ah_table = [round(saturation_abs_humidity(t) * 1000 * (1 << AH_UNIT_SHIFT)) for t in t_grid]
+
+    return f"""/* Generated by scripts/gen_psychro_tables.py, do not edit. */
+#ifndef PSYCHRO_TABLES_H
+#define PSYCHRO_TABLES_H
+
+#include <stdint.h>
+
+#define PSYCHRO_MAGNUS_B_Q16 {round(MAGNUS_B * 65536)}
+#define PSYCHRO_MAGNUS_C_MILLI {round(MAGNUS_C_DEGC * 1000)}
+#define PSYCHRO_LN2_Q16 {round(math.log(2) * 65536)}
+#define PSYCHRO_LN_100000_Q16 {round(math.log(100000) * 65536)}
+
+// ln(1 + i / 2^PSYCHRO_LN_TABLE_BITS), Q16
+#define PSYCHRO_LN_TABLE_BITS {LN_TABLE_BITS}
+{table("uint16_t", "psychro_ln_table", ln_table)}
+
+// Temperature grid of the tables below: T_MIN_MILLI + (i << T_STEP_SHIFT) milli-degC
+#define PSYCHRO_T_MIN_MILLI ({T_MIN_MILLI})
+#define PSYCHRO_T_MAX_MILLI {T_MAX_MILLI}
+#define PSYCHRO_T_STEP_SHIFT {T_STEP_SHIFT}
+
+// b * T / (c + T), Q16
+{table("int32_t", "psychro_magnus_table", magnus_table)}
+
+// Absolute humidity of saturated air, in 2^-PSYCHRO_AH_UNIT_SHIFT mg/m^3
+#define PSYCHRO_AH_UNIT_SHIFT {AH_UNIT_SHIFT}
+{table("int32_t", "psychro_ah_table", ah_table)}
+
+#endif
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("output", help="header to generate")
+    args = parser.parse_args()
+
+    with open(args.output, "w", encoding="utf-8") as header:
+        header.write(generate())
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
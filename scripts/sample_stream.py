@@ -0,0 +1,270 @@
+#!/usr/bin/env python3
+"""Decodes the binary sample stream of CONFIG_SAMPLE_STREAM (see src/sample_stream.h).
+
+Reads a serial port, a pseudo-terminal (the native_sim uart_1 PTY) or a capture file, checks the COBS framing, the CRC
+and the sequence numbers, converts the raw samples with the calibration of the info frames and prints them. Also
+decodes the CBOR telemetry frames of CONFIG_TELEMETRY. With --duration, stops after that many seconds and fails if
+frames were lost or the sample rate stayed below --min-rate.
+"""
+
+import argparse
+import binascii
+import os
+import struct
+import sys
+import time
+
+VERSION = 1
+INFO = 1
+SAMPLES = 2
+TELEMETRY = 3
+
+TELEMETRY_VERSION = 1
+TELEMETRY_RAW = 0
+
+HEADER = struct.Struct("<BH")  # type, sequence
+INFO_HEADER = struct.Struct("<BIIB")  # version, timestamp frequency, device drops, sensor count
+CALIBRATION = struct.Struct("<iihiih")  # t0_milli, t_slope_q16, t0_out, rh0_milli, rh_slope_q16, h0_out
+SAMPLE = struct.Struct("<II")  # timestamp, humidity | temperature << 10 | sensor << 20
+
+
+def cobs_decode(data):
+    """Returns the decoded frame, or None if the COBS encoding is broken."""
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1 : i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def cbor_decode(data, pos=0):
+    """Decodes the CBOR subset of the telemetry messages (integers, arrays), returns the item and the next position."""
+    initial = data[pos]
+    major, info = initial >> 5, initial & 0x1F
+    pos += 1
+    if major == 4 and info == 31:  # indefinite length array
+        items = []
+        while data[pos] != 0xFF:
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos + 1
+    if info < 24:
+        value = info
+    elif info <= 27:
+        size = 1 << (info - 24)
+        value = int.from_bytes(data[pos : pos + size], "big")
+        pos += size
+    else:
+        raise ValueError(f"unsupported CBOR item 0x{initial:02x}")
+
+    if major == 0:
+        return value, pos
+    if major == 1:
+        return -1 - value, pos
+    if major == 4:
+        items = []
+        for _ in range(value):
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos
+    raise ValueError(f"unsupported CBOR item 0x{initial:02x}")
+
+
+def linear_milli(x0_milli, x0_out, slope_q16, raw):
+    """Same calibration line as hts221_calib_temperature_milli() and hts221_calib_humidity_milli()."""
+    return x0_milli + (((raw - x0_out) * slope_q16 + (1 << 15)) >> 16)
+
+
+class Decoder:
+    def __init__(self, output):
+        self.output = output
+        self.buffer = bytearray()
+        self.synced = False  # bad frames before the first good one are the tail of a frame sent before we started
+        self.frequency = None
+        self.calibration = []
+        self.sequence = None
+        self.last_timestamp = None
+        self.time_base = 0
+        self.first_seconds = None
+        self.first_samples = 0
+        self.last_seconds = None
+        self.frames = 0
+        self.samples = 0
+        self.lost = 0
+        self.errors = 0
+        self.device_drops = 0
+
+    def feed(self, data):
+        self.buffer += data
+        while True:
+            end = self.buffer.find(0)
+            if end < 0:
+                return
+            frame = bytes(self.buffer[:end])
+            del self.buffer[: end + 1]
+            if frame:
+                self.frame(frame)
+
+    def frame(self, encoded):
+        payload = cobs_decode(encoded)
+        if payload is None or len(payload) < HEADER.size + 2:
+            self.errors += self.synced
+            return
+        body, crc = payload[:-2], struct.unpack("<H", payload[-2:])[0]
+        if binascii.crc_hqx(body, 0xFFFF) != crc:
+            self.errors += self.synced
+            return
+        self.synced = True
+
+        frame_type, sequence = HEADER.unpack_from(body)
+        if self.sequence is not None:
+            self.lost += (sequence - self.sequence - 1) & 0xFFFF
+        self.sequence = sequence
+        self.frames += 1
+
+        if frame_type == INFO:
+            self.info(body[HEADER.size :])
+        elif frame_type == SAMPLES:
+            self.sample_frame(body[HEADER.size :])
+        elif frame_type == TELEMETRY:
+            self.telemetry_frame(body[HEADER.size :])
+        else:
+            self.errors += 1
+
+    def info(self, body):
+        version, self.frequency, self.device_drops, count = INFO_HEADER.unpack_from(body)
+        if version != VERSION:
+            sys.exit(f"unsupported stream version {version}")
+        self.calibration = [
+            CALIBRATION.unpack_from(body, INFO_HEADER.size + i * CALIBRATION.size) for i in range(count)
+        ]
+
+    def sample_frame(self, body):
+        for i in range(body[0]):
+            timestamp, packed = SAMPLE.unpack_from(body, 1 + i * SAMPLE.size)
+            humidity, temperature, sensor = packed & 0x3FF, (packed >> 10) & 0x3FF, (packed >> 20) & 0x1F
+            self.samples += 1
+
+            if self.frequency is None or sensor >= len(self.calibration):
+                if self.output:
+                    print(f"sensor {sensor}: cycles {timestamp}, raw humidity {humidity}, temperature {temperature}")
+                continue
+
+            # Unwrap the 32-bit cycle counter
+            if self.last_timestamp is not None and timestamp < self.last_timestamp:
+                self.time_base += 1 << 32
+            self.last_timestamp = timestamp
+            self.timestamp((self.time_base + timestamp) / self.frequency)
+            self.print_sample(sensor, *self.convert(sensor, humidity, temperature))
+
+    def telemetry_frame(self, body):
+        try:
+            (version, value_format, base_ms, samples), _ = cbor_decode(body)
+        except (ValueError, IndexError, TypeError):
+            self.errors += 1
+            return
+        if version != TELEMETRY_VERSION:
+            sys.exit(f"unsupported telemetry version {version}")
+
+        timestamp_ms = base_ms
+        for i in range(0, len(samples) - 3, 4):
+            offset_ms, sensor, humidity, temperature = samples[i : i + 4]
+            timestamp_ms += offset_ms
+            self.samples += 1
+            self.timestamp(timestamp_ms / 1000)
+
+            if value_format != TELEMETRY_RAW:
+                self.print_sample(sensor, humidity, temperature)
+            elif sensor < len(self.calibration):
+                self.print_sample(sensor, *self.convert(sensor, humidity, temperature))
+            elif self.output:
+                print(f"sensor {sensor}: ms {timestamp_ms}, raw humidity {humidity}, temperature {temperature}")
+
+    def timestamp(self, seconds):
+        self.last_seconds = seconds
+        if self.first_seconds is None:
+            self.first_seconds = seconds
+            self.first_samples = self.samples
+
+    def convert(self, sensor, humidity, temperature):
+        """Returns the humidity and the temperature in milli-units."""
+        t0_milli, t_slope_q16, t0_out, rh0_milli, rh_slope_q16, h0_out = self.calibration[sensor]
+        rh = linear_milli(rh0_milli, h0_out, rh_slope_q16, humidity)
+        t = linear_milli(t0_milli, t0_out, t_slope_q16, temperature)
+        return rh, t
+
+    def print_sample(self, sensor, rh, t):
+        if self.output:
+            print(
+                f"{self.last_seconds:12.3f} s  sensor {sensor}: humidity = {rh / 1000:7.3f} %RH, "
+                f"temperature = {t / 1000:7.3f} degC"
+            )
+
+    def rate(self):
+        """Samples per second of device time, since the first sample with a known timestamp frequency."""
+        if self.first_seconds is None or self.last_seconds <= self.first_seconds:
+            return 0
+        return (self.samples - self.first_samples) / (self.last_seconds - self.first_seconds)
+
+
+def open_stream(port, baudrate):
+    """Returns a read(size) function for a capture file, a serial port (pyserial) or a PTY."""
+    if os.path.isfile(port):
+        stream = open(port, "rb")
+        return stream.read
+    try:
+        import serial
+
+        return serial.Serial(port, baudrate, timeout=0.1).read
+    except ImportError:
+        # Without pyserial the port keeps its current settings, which is fine for a PTY
+        fd = os.open(port, os.O_RDONLY | os.O_NOCTTY)
+        return lambda size: os.read(fd, size)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", help="serial port, PTY or capture file")
+    parser.add_argument("-b", "--baudrate", type=int, default=115200)
+    parser.add_argument("-q", "--quiet", action="store_true", help="only print the statistics")
+    parser.add_argument("--duration", type=float, help="stop after this many seconds and check the rates")
+    parser.add_argument("--min-rate", type=float, default=12.0, help="minimum sample rate (Hz) for --duration")
+    args = parser.parse_args()
+
+    read = open_stream(args.port, args.baudrate)
+    decoder = Decoder(not args.quiet)
+    start = time.monotonic()
+    received = 0
+
+    try:
+        while args.duration is None or time.monotonic() - start < args.duration:
+            data = read(256)
+            if not data and os.path.isfile(args.port):
+                break
+            received += len(data)
+            decoder.feed(data)
+    except KeyboardInterrupt:
+        pass
+
+    elapsed = time.monotonic() - start
+    rate = decoder.rate()
+    throughput = received / elapsed if elapsed > 0 else 0
+    print(
+        f"{decoder.frames} frames, {decoder.samples} samples ({rate:.2f} Hz), {throughput:.0f} B/s, "
+        f"{decoder.lost} frames lost ({decoder.device_drops} dropped on the device), {decoder.errors} bad frames",
+        file=sys.stderr,
+    )
+
+    if args.duration is not None and (decoder.lost or decoder.errors or rate < args.min_rate):
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,46 @@
+#include "adaptive_sched.h"
+
+#include <stdlib.h>
+#include <zephyr/sys/util.h>
+
+void adaptive_sched_init(struct adaptive_sched *sched) {
+    *sched = (struct adaptive_sched){.period_ms = CONFIG_HTS221_ADAPTIVE_MAX_PERIOD_MS};
+}
+
+/**
+ * @brief Returns the rate of change between two samples, in milli-units per second.
+ */
+static uint32_t adaptive_sched_rate(const int32_t value, const int32_t last_value, const int64_t interval_ms) {
+    return (uint32_t)(abs(value - last_value) * 1000LL / MAX(interval_ms, 1));
+}
+
+bool adaptive_sched_update(struct adaptive_sched *sched, const size_t sensor, const int32_t temperature,
+                           const int32_t humidity, const int64_t now_ms) {
+    const uint32_t period_ms = sched->period_ms;
+
+    if (sched->has_last[sensor]) {
+        const int64_t interval_ms = now_ms - sched->last_sample_ms[sensor];
+        const uint32_t temp_rate = adaptive_sched_rate(temperature, sched->last_temperature[sensor], interval_ms);
+        const uint32_t humidity_rate = adaptive_sched_rate(humidity, sched->last_humidity[sensor], interval_ms);
+
+        if (temp_rate > CONFIG_HTS221_ADAPTIVE_TEMP_RATE || humidity_rate > CONFIG_HTS221_ADAPTIVE_HUMIDITY_RATE) {
+            sched->period_ms = CONFIG_HTS221_ADAPTIVE_MIN_PERIOD_MS;
+            sched->stable_samples = 0;
+        } else if (temp_rate <= CONFIG_HTS221_ADAPTIVE_TEMP_RATE / 2 &&
+                   humidity_rate <= CONFIG_HTS221_ADAPTIVE_HUMIDITY_RATE / 2) {
+            if (++sched->stable_samples >= CONFIG_HTS221_ADAPTIVE_STABLE_SAMPLES) {
+                sched->period_ms = MIN(2 * sched->period_ms, CONFIG_HTS221_ADAPTIVE_MAX_PERIOD_MS);
+                sched->stable_samples = 0;
+            }
+        } else {
+            sched->stable_samples = 0;
+        }
+    }
+
+    sched->last_temperature[sensor] = temperature;
+    sched->last_humidity[sensor] = humidity;
+    sched->last_sample_ms[sensor] = now_ms;
+    sched->has_last[sensor] = true;
+
+    return sched->period_ms != period_ms;
+}
@@ -0,0 +1,47 @@
+#ifndef ADAPTIVE_SCHED_H
+#define ADAPTIVE_SCHED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hts221/hts221.h"
+
+/**
+ * @brief Sampling period chosen from the rate of change of the samples.
+ *
+ * @details The period drops to CONFIG_HTS221_ADAPTIVE_MIN_PERIOD_MS as soon as the temperature or humidity rate of
+ * change of any sensor exceeds its threshold. It doubles, up to CONFIG_HTS221_ADAPTIVE_MAX_PERIOD_MS, after
+ * CONFIG_HTS221_ADAPTIVE_STABLE_SAMPLES consecutive samples below half the thresholds. Rates between half and the full
+ * threshold keep the current period (hysteresis).
+ */
+struct adaptive_sched {
+    uint32_t period_ms;
+    uint32_t stable_samples;
+    int32_t last_temperature[HTS221_DEV_COUNT];  // milli-degC
+    int32_t last_humidity[HTS221_DEV_COUNT];     // milli-%RH
+    int64_t last_sample_ms[HTS221_DEV_COUNT];
+    bool has_last[HTS221_DEV_COUNT];
+};
+
+/**
+ * @brief Starts the scheduler at the slowest period.
+ *
+ * @param sched Scheduler state.
+ */
+void adaptive_sched_init(struct adaptive_sched *sched);
+
+/**
+ * @brief Adds one sample and updates the sampling period.
+ *
+ * @param sched Scheduler state.
+ * @param sensor Index of the sensor in hts221_devs[].
+ * @param temperature Temperature in milli-degC.
+ * @param humidity Relative humidity in milli-%RH.
+ * @param now_ms k_uptime_get() when the sample was taken.
+ * @return true if the sampling period changed.
+ */
+bool adaptive_sched_update(struct adaptive_sched *sched, const size_t sensor, const int32_t temperature,
+                           const int32_t humidity, const int64_t now_ms);
+
+#endif
@@ -0,0 +1,153 @@
+#include "calib_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/crc.h>
+
+#include "config_log.h"
+
+#define CALIB_CACHE_SUBTREE "hts221"
+#define CALIB_CACHE_KEY_SIZE 48
+
+struct calib_cache_entry {
+    uint32_t raw_crc;  // crc32_ieee() of the raw CALIB block the coefficients were computed from
+    struct Hts221_calibration_coeff calibration;
+};
+
+static struct calib_cache_entry calib_cache_entries[HTS221_DEV_COUNT];
+static bool calib_cache_loaded[HTS221_DEV_COUNT];  // entry read from the settings
+static bool calib_cache_used[HTS221_DEV_COUNT];    // entry copied into the device context, to be verified
+
+/**
+ * @brief Builds the settings key of a sensor, relative to CALIB_CACHE_SUBTREE.
+ */
+static void calib_cache_key(const struct hts221_dev *dev, char *key, const size_t size) {
+    snprintf(key, size, "%s-%02x", dev->i2c.bus->name, dev->i2c.addr);
+}
+
+static int calib_cache_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg) {
+    char key[CALIB_CACHE_KEY_SIZE];
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        calib_cache_key(&hts221_devs[i], key, sizeof(key));
+        if (strcmp(name, key) != 0)
+            continue;
+
+        // Entries written by a build with a different coefficient layout (float vs fixed point) are ignored
+        if (len != sizeof(calib_cache_entries[i]))
+            return 0;
+
+        const ssize_t read = read_cb(cb_arg, &calib_cache_entries[i], sizeof(calib_cache_entries[i]));
+        calib_cache_loaded[i] = (read == sizeof(calib_cache_entries[i]));
+        return 0;
+    }
+
+    return 0;  // entry of a sensor that is no longer in the devicetree
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(calib_cache, CALIB_CACHE_SUBTREE, NULL, calib_cache_set, NULL, NULL);
+
+int calib_cache_init(void) {
+    const int err = settings_subsys_init();
+    if (err != 0)
+        return err;
+
+    return settings_load_subtree(CALIB_CACHE_SUBTREE);
+}
+
+int calib_cache_load(struct hts221_dev *dev) {
+    const size_t i = dev - hts221_devs;
+    if (!calib_cache_loaded[i])
+        return -ENOENT;
+
+    dev->calibration = calib_cache_entries[i].calibration;
+    calib_cache_used[i] = true;
+
+    return 0;
+}
+
+/**
+ * @brief Stores the calibration of a sensor with the CRC of the raw block it was computed from.
+ */
+static int calib_cache_save(struct hts221_dev *dev, const struct Hts221_calibration_coeff *calibration,
+                            const uint32_t raw_crc) {
+    const size_t i = dev - hts221_devs;
+    char key[sizeof(CALIB_CACHE_SUBTREE) + CALIB_CACHE_KEY_SIZE] = CALIB_CACHE_SUBTREE "/";
+
+    calib_cache_key(dev, &key[sizeof(CALIB_CACHE_SUBTREE)], CALIB_CACHE_KEY_SIZE);
+    calib_cache_entries[i] = (struct calib_cache_entry){.raw_crc = raw_crc, .calibration = *calibration};
+    calib_cache_loaded[i] = true;
+
+    return settings_save_one(key, &calib_cache_entries[i], sizeof(calib_cache_entries[i]));
+}
+
+int calib_cache_refresh(struct hts221_dev *dev) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    uint8_t raw[HTS221_CALIB_SIZE];
+    int err = hts221_read_calibration_raw(dev, raw);
+    if (err != 0)
+        return err;
+
+    err = hts221_calibration_from_raw(&dev->calibration, raw);
+    if (err != 0)
+        return err;
+
+    // Without the cache the next boot only has to read the calibration again
+    err = calib_cache_save(dev, &dev->calibration, crc32_ieee(raw, sizeof(raw)));
+    if (err != 0)
+        LOG_WRN("Error %d: failed to store HTS221 (I2C@%x) calibration.", err, dev->i2c.addr);
+
+    return 0;
+}
+
+static void calib_cache_verify(struct k_work *work) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct Hts221_calibration_coeff calibration;
+    uint8_t raw[HTS221_CALIB_SIZE];
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        struct hts221_dev *hts221 = &hts221_devs[i];
+        if (!calib_cache_used[i])
+            continue;
+
+        pm_device_runtime_get(hts221->i2c.bus);
+        int err = hts221_read_calibration_raw(hts221, raw);
+        pm_device_runtime_put(hts221->i2c.bus);
+        if (err != 0) {
+            LOG_WRN("Error %d: failed to verify HTS221 (I2C@%x) cached calibration.", err, hts221->i2c.addr);
+            continue;
+        }
+
+        const uint32_t raw_crc = crc32_ieee(raw, sizeof(raw));
+        if (raw_crc == calib_cache_entries[i].raw_crc) {
+            LOG_DBG("HTS221 (I2C@%x) cached calibration verified.", hts221->i2c.addr);
+            continue;
+        }
+
+        err = hts221_calibration_from_raw(&calibration, raw);
+        if (err != 0) {
+            LOG_ERR("Error %d: HTS221 (I2C@%x) calibration data not valid.", err, hts221->i2c.addr);
+            continue;
+        }
+
+        // The sample consumers convert in thread context: keep them out while the coefficients change
+        k_sched_lock();
+        hts221->calibration = calibration;
+        k_sched_unlock();
+
+        LOG_WRN("HTS221 (I2C@%x) cached calibration out of date, replaced.", hts221->i2c.addr);
+        err = calib_cache_save(hts221, &calibration, raw_crc);
+        if (err != 0)
+            LOG_ERR("Error %d: failed to store HTS221 (I2C@%x) calibration.", err, hts221->i2c.addr);
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(calib_cache_verify_work, calib_cache_verify);
+
+void calib_cache_verify_later(void) {
+    k_work_schedule(&calib_cache_verify_work, K_MSEC(CONFIG_HTS221_CALIB_VERIFY_DELAY_MS));
+}
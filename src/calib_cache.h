@@ -0,0 +1,42 @@
+#ifndef CALIB_CACHE_H
+#define CALIB_CACHE_H
+
+#include "hts221/hts221.h"
+
+/*
+ * HTS221 calibration coefficients cached with the settings subsystem, so that a reboot does not need to read and
+ * convert the CALIB block before the first sample. Entries are keyed by the sensor identity (I2C bus and address) and
+ * carry a CRC of the raw CALIB block, which is checked in the background after boot.
+ */
+
+/**
+ * @brief Initializes the settings subsystem and loads the cached entries.
+ *
+ * @return 0 on success, otherwise a value from settings_subsys_init() or settings_load_subtree().
+ */
+int calib_cache_init(void);
+
+/**
+ * @brief Copies the cached calibration coefficients of the sensor into its device context.
+ *
+ * @param dev HTS221 device context.
+ * @return 0 on success, -ENOENT if the sensor has no cached entry.
+ */
+int calib_cache_load(struct hts221_dev *dev);
+
+/**
+ * @brief Reads the calibration from the sensor and stores it in the device context and in the cache.
+ *
+ * @details A failure to store the cache entry is only logged: the device context is valid anyway.
+ *
+ * @param dev HTS221 device context.
+ * @return 0 on success, otherwise a value from hts221_read_calibration_raw() or hts221_calibration_from_raw().
+ */
+int calib_cache_refresh(struct hts221_dev *dev);
+
+/**
+ * @brief Schedules the background check of the entries used by calib_cache_load() against the sensors.
+ */
+void calib_cache_verify_later(void);
+
+#endif
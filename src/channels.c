@@ -0,0 +1,48 @@
+#include "channels.h"
+
+#include "hts221/hts221.h"
+#include "led_indicator.h"
+
+#define COMMAND_MSGQ_DEPTH 4
+#define STATUS_MSGQ_DEPTH 8
+#define DRDY_MSGQ_DEPTH (2 * HTS221_DEV_COUNT)  // DRDY cannot fire again before the sample is read
+
+K_MSGQ_DEFINE(hts221_command_msgq, sizeof(struct command_msg), COMMAND_MSGQ_DEPTH, 4);
+K_MSGQ_DEFINE(hts221_drdy_msgq, sizeof(struct drdy_msg), DRDY_MSGQ_DEPTH, 4);
+K_MSGQ_DEFINE(led_status_msgq, sizeof(struct status_msg), STATUS_MSGQ_DEPTH, 4);
+SAMPLE_RING_DEFINE(sample_log_ring);
+
+MSG_CHAN_DEFINE(command_chan, &hts221_command_msgq);
+MSG_CHAN_DEFINE_NOTIFY(status_chan, led_indicator_notify, &led_status_msgq);
+MSG_CHAN_DEFINE(drdy_chan, &hts221_drdy_msgq);
+SAMPLE_CHAN_DEFINE(sample_chan, &sample_log_ring);
+
+int msg_chan_pub(struct msg_chan *chan, const void *msg) {
+    int ret = 0;
+
+    for (size_t i = 0; i < chan->subscriber_count; i++) {
+        if (k_msgq_put(chan->subscribers[i], msg, K_NO_WAIT) != 0) {
+            atomic_inc(&chan->drops);
+            ret = -ENOMSG;
+        }
+    }
+    if (chan->notify != NULL)
+        chan->notify();
+
+    return ret;
+}
+
+int sample_chan_pub(struct sample_chan *chan, const struct sample *sample) {
+    int ret = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&chan->lock);
+    for (size_t i = 0; i < chan->subscriber_count; i++) {
+        if (!sample_ring_put(chan->subscribers[i], sample))
+            ret = -ENOMSG;
+    }
+    k_spin_unlock(&chan->lock, key);
+
+    return ret;
+}
+
+uint32_t msg_chan_drops(struct msg_chan *chan) { return (uint32_t)atomic_get(&chan->drops); }
@@ -0,0 +1,114 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "sample_ring.h"
+
+/*
+ * Typed publish/subscribe channels between the application threads.
+ *
+ * Every subscriber owns its queue, so a slow consumer never delays the others. Publishing never blocks (it can be done
+ * from an ISR): when a subscriber queue is full the message is dropped for that subscriber only and counted in the
+ * channel drops.
+ */
+
+typedef enum {
+    COMMAND_HTS221_READ_ALL,  // start one conversion on every HTS221 (one-shot mode)
+} command_t;
+
+typedef enum {
+    STATUS_SAMPLE_OK,
+    STATUS_I2C_ERROR,
+    STATUS_TIMEOUT,
+    STATUS_OVERFLOW,
+} status_t;
+
+struct command_msg {
+    command_t command;
+};
+
+struct status_msg {
+    status_t status;
+    uint8_t sensor;  // index in hts221_devs[]
+};
+
+struct drdy_msg {
+    uint32_t timestamp;  // k_cycle_get_32() at the DRDY edge
+    uint8_t sensor;      // index in hts221_devs[]
+};
+
+struct msg_chan {
+    struct k_msgq *const *subscribers;
+    const size_t subscriber_count;
+    void (*const notify)(void);  // optional, called after every publish, e.g. to wake a subscriber without a thread
+    atomic_t drops;
+};
+
+struct sample_chan {
+    struct sample_ring *const *subscribers;
+    const size_t subscriber_count;
+    struct k_spinlock lock;  // the subscriber rings are single-producer, publishers can run concurrently
+};
+
+#define MSG_CHAN_DEFINE_NOTIFY(name, notify_fn, ...)                 \
+    static struct k_msgq *const name##_subscribers[] = {__VA_ARGS__}; \
+    struct msg_chan name = {                                          \
+        .subscribers = name##_subscribers,                            \
+        .subscriber_count = ARRAY_SIZE(name##_subscribers),           \
+        .notify = notify_fn,                                          \
+    }
+
+#define MSG_CHAN_DEFINE(name, ...) MSG_CHAN_DEFINE_NOTIFY(name, NULL, __VA_ARGS__)
+
+#define SAMPLE_CHAN_DEFINE(name, ...)                                      \
+    static struct sample_ring *const name##_subscribers[] = {__VA_ARGS__}; \
+    struct sample_chan name = {                                            \
+        .subscribers = name##_subscribers,                                 \
+        .subscriber_count = ARRAY_SIZE(name##_subscribers),                \
+    }
+
+// Channels
+extern struct msg_chan command_chan;  // struct command_msg, button -> HTS221 thread
+extern struct msg_chan status_chan;   // struct status_msg, HTS221 thread -> LED indicator
+extern struct msg_chan drdy_chan;     // struct drdy_msg, DRDY ISR -> HTS221 thread
+extern struct sample_chan sample_chan;
+
+// Subscriber queues
+extern struct k_msgq hts221_command_msgq;
+extern struct k_msgq hts221_drdy_msgq;
+extern struct k_msgq led_status_msgq;
+extern struct sample_ring sample_log_ring;
+
+/**
+ * @brief Publishes a message to every subscriber of the channel. Never blocks, can be called from ISRs.
+ *
+ * @param chan Channel.
+ * @param msg Message, of the type carried by the channel.
+ * @return 0 if every subscriber received the message, -ENOMSG if at least one subscriber queue was full.
+ */
+int msg_chan_pub(struct msg_chan *chan, const void *msg);
+
+/**
+ * @brief Publishes a sample to every subscriber ring of the sample channel. Never blocks, can be called from ISRs.
+ *
+ * @details Publishers are serialised by the channel lock, so the completions of concurrent asynchronous reads of
+ * several sensors can publish from their own contexts into the single-producer rings.
+ *
+ * @param chan Sample channel.
+ * @param sample Sample to publish.
+ * @return 0 if every subscriber received the sample, -ENOMSG if at least one subscriber ring was full.
+ */
+int sample_chan_pub(struct sample_chan *chan, const struct sample *sample);
+
+/**
+ * @brief Returns the number of messages dropped by the channel because a subscriber queue was full.
+ *
+ * @param chan Channel.
+ */
+uint32_t msg_chan_drops(struct msg_chan *chan);
+
+#endif
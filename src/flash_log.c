@@ -0,0 +1,276 @@
+#include "flash_log.h"
+
+#include <string.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "config_log.h"
+#include "hts221/hts221.h"
+
+#if FIXED_PARTITION_EXISTS(sample_log_partition)
+#define FLASH_LOG_AREA_ID FIXED_PARTITION_ID(sample_log_partition)
+#else
+// Without MCUboot the second image slot is spare flash
+BUILD_ASSERT(!IS_ENABLED(CONFIG_BOOTLOADER_MCUBOOT), "Define a sample_log_partition for the flash log");
+#define FLASH_LOG_AREA_ID FIXED_PARTITION_ID(slot1_partition)
+#endif
+
+#define FLASH_LOG_MAGIC 0x48545331  // "HTS1"
+#define FLASH_LOG_VERSION 1
+#define FLASH_LOG_SENSOR_BITS 5
+#define FLASH_LOG_HEADER_MAX (5 + 10 + 1)  // varint sequence, varint base uptime, sample count
+#define FLASH_LOG_SAMPLE_MAX (6 + 2 + 2)   // varint zigzag time delta and sensor, varint zigzag raw word deltas
+#define FLASH_LOG_RECORD_MAX (FLASH_LOG_HEADER_MAX + CONFIG_SAMPLE_FLASH_LOG_RECORD_SAMPLES * FLASH_LOG_SAMPLE_MAX)
+
+BUILD_ASSERT(HTS221_DEV_COUNT <= BIT(FLASH_LOG_SENSOR_BITS), "Too many HTS221 for the flash log sample encoding");
+
+/**
+ * @brief Record being encoded in RAM.
+ */
+struct flash_log_record {
+    uint8_t samples[CONFIG_SAMPLE_FLASH_LOG_RECORD_SAMPLES * FLASH_LOG_SAMPLE_MAX];
+    size_t len;
+    uint8_t count;
+    int64_t base_ms;  // uptime of the first sample
+    int64_t last_ms;  // uptime of the previous sample
+    uint16_t last_humidity[HTS221_DEV_COUNT];
+    uint16_t last_temperature[HTS221_DEV_COUNT];
+};
+
+static struct flash_sector flash_log_sectors[CONFIG_SAMPLE_FLASH_LOG_MAX_SECTORS];
+static struct fcb flash_log_fcb;
+static struct flash_log_record flash_log_current;
+static uint32_t flash_log_next_record;
+static uint8_t flash_log_buffer[FLASH_LOG_RECORD_MAX];  // encoded record, for appends and reads
+
+/************
+ * Encoding *
+ ************/
+
+static size_t varint_put(uint8_t *buffer, uint64_t value) {
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        buffer[len++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    buffer[len++] = (uint8_t)value;
+
+    return len;
+}
+
+/**
+ * @brief Decodes a varint, returning the number of bytes used or 0 if the buffer ends before the varint.
+ */
+static size_t varint_get(const uint8_t *buffer, const size_t size, uint64_t *value) {
+    *value = 0;
+
+    for (size_t len = 0; len < size && len < 10; len++) {
+        *value |= (uint64_t)(buffer[len] & 0x7f) << (7 * len);
+        if (!(buffer[len] & 0x80))
+            return len + 1;
+    }
+
+    return 0;
+}
+
+static uint64_t zigzag_encode(const int64_t value) { return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); }
+
+static int64_t zigzag_decode(const uint64_t value) { return (int64_t)(value >> 1) ^ -(int64_t)(value & 1); }
+
+/**
+ * @brief Returns the uptime of a sample from its DRDY cycle counter, valid while the counter has not wrapped around.
+ */
+static int64_t flash_log_sample_ms(const struct sample *sample) {
+    const uint32_t now_cyc = k_cycle_get_32();
+    const int64_t now_ms = k_uptime_get();
+
+    return now_ms - k_cyc_to_ms_floor32(now_cyc - sample->timestamp);
+}
+
+/*********
+ * Flash *
+ *********/
+
+/**
+ * @brief Reads the FCB entry of a record into flash_log_buffer.
+ */
+static int flash_log_read_entry(struct fcb_entry_ctx *entry_ctx, size_t *len) {
+    *len = MIN(entry_ctx->loc.fe_data_len, sizeof(flash_log_buffer));
+    return flash_area_read(entry_ctx->fap, FCB_ENTRY_FA_DATA_OFF(entry_ctx->loc), flash_log_buffer, *len);
+}
+
+static int flash_log_find_last(struct fcb_entry_ctx *entry_ctx, void *arg) {
+    uint32_t *records = arg;
+    uint64_t sequence;
+    size_t len;
+
+    if (flash_log_read_entry(entry_ctx, &len) != 0 || varint_get(flash_log_buffer, len, &sequence) == 0)
+        return 0;  // skip unreadable records
+
+    flash_log_next_record = MAX(flash_log_next_record, (uint32_t)sequence + 1);
+    (*records)++;
+
+    return 0;
+}
+
+int flash_log_init(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    uint32_t sector_count = ARRAY_SIZE(flash_log_sectors);
+    uint32_t records = 0;
+
+    int err = flash_area_get_sectors(FLASH_LOG_AREA_ID, &sector_count, flash_log_sectors);
+    if (err != 0)
+        return err;
+
+    flash_log_fcb.f_magic = FLASH_LOG_MAGIC;
+    flash_log_fcb.f_version = FLASH_LOG_VERSION;
+    flash_log_fcb.f_sector_cnt = sector_count;
+    flash_log_fcb.f_scratch_cnt = 0;
+    flash_log_fcb.f_sectors = flash_log_sectors;
+
+    err = fcb_init(FLASH_LOG_AREA_ID, &flash_log_fcb);
+    if (err != 0)
+        return err;
+
+    err = fcb_walk(&flash_log_fcb, NULL, flash_log_find_last, &records);
+    if (err != 0)
+        return err;
+
+    LOG_INF("Flash log: %u sectors, %u records stored.", sector_count, records);
+
+    return 0;
+}
+
+int flash_log_add(const struct sample *sample) {
+    struct flash_log_record *record = &flash_log_current;
+    const int64_t sample_ms = flash_log_sample_ms(sample);
+
+    if (record->count == 0) {
+        memset(record, 0, sizeof(*record));
+        record->base_ms = sample_ms;
+        record->last_ms = sample_ms;
+    }
+
+    // The sensor index shares the varint of the time delta, the raw words are deltas from the same sensor
+    const uint64_t time_sensor = (zigzag_encode(sample_ms - record->last_ms) << FLASH_LOG_SENSOR_BITS) | sample->sensor;
+    record->len += varint_put(&record->samples[record->len], time_sensor);
+    record->len += varint_put(&record->samples[record->len],
+                              zigzag_encode((int32_t)sample->humidity - record->last_humidity[sample->sensor]));
+    record->len += varint_put(&record->samples[record->len],
+                              zigzag_encode((int32_t)sample->temperature - record->last_temperature[sample->sensor]));
+
+    record->last_ms = sample_ms;
+    record->last_humidity[sample->sensor] = sample->humidity;
+    record->last_temperature[sample->sensor] = sample->temperature;
+    record->count++;
+
+    if (record->count < CONFIG_SAMPLE_FLASH_LOG_RECORD_SAMPLES)
+        return 0;
+
+    return flash_log_flush();
+}
+
+int flash_log_flush(void) {
+    struct flash_log_record *record = &flash_log_current;
+    struct fcb_entry entry;
+
+    if (record->count == 0)
+        return 0;
+
+    size_t len = varint_put(flash_log_buffer, flash_log_next_record);
+    len += varint_put(&flash_log_buffer[len], (uint64_t)record->base_ms);
+    flash_log_buffer[len++] = record->count;
+    memcpy(&flash_log_buffer[len], record->samples, record->len);
+    len += record->len;
+    record->count = 0;  // from here on the record is either in flash or lost
+
+    int err = fcb_append(&flash_log_fcb, len, &entry);
+    if (err == -ENOSPC) {
+        // Log full: erase the oldest sector and reuse it
+        err = fcb_rotate(&flash_log_fcb);
+        if (err == 0)
+            err = fcb_append(&flash_log_fcb, len, &entry);
+    }
+    if (err != 0)
+        return err;
+
+    err = flash_area_write(flash_log_fcb.fap, FCB_ENTRY_FA_DATA_OFF(entry), flash_log_buffer, len);
+    if (err != 0)
+        return err;
+
+    err = fcb_append_finish(&flash_log_fcb, &entry);
+    if (err != 0)
+        return err;
+
+    flash_log_next_record++;
+
+    return 0;
+}
+
+/***********
+ * Reading *
+ ***********/
+
+struct flash_log_walk_ctx {
+    flash_log_cb_t cb;
+    void *user_data;
+    int ret;
+};
+
+static int flash_log_decode(struct fcb_entry_ctx *entry_ctx, void *arg) {
+    struct flash_log_walk_ctx *ctx = arg;
+    uint16_t humidity[HTS221_DEV_COUNT] = {0}, temperature[HTS221_DEV_COUNT] = {0};
+    uint64_t sequence, base_ms, value;
+    size_t len, used, pos = 0;
+
+    if (flash_log_read_entry(entry_ctx, &len) != 0)
+        return 0;  // skip unreadable records
+
+    used = varint_get(&flash_log_buffer[pos], len - pos, &sequence);
+    pos += used;
+    if (used == 0 || (used = varint_get(&flash_log_buffer[pos], len - pos, &base_ms)) == 0 || pos + used >= len)
+        return 0;
+    pos += used;
+
+    struct flash_log_sample sample = {.record = sequence, .uptime_ms = base_ms};
+    const uint8_t count = flash_log_buffer[pos++];
+
+    for (uint8_t i = 0; i < count; i++) {
+        if ((used = varint_get(&flash_log_buffer[pos], len - pos, &value)) == 0)
+            return 0;
+        pos += used;
+        sample.sensor = value & BIT_MASK(FLASH_LOG_SENSOR_BITS);
+        sample.uptime_ms += zigzag_decode(value >> FLASH_LOG_SENSOR_BITS);
+        if (sample.sensor >= HTS221_DEV_COUNT)
+            return 0;
+
+        if ((used = varint_get(&flash_log_buffer[pos], len - pos, &value)) == 0)
+            return 0;
+        pos += used;
+        humidity[sample.sensor] += zigzag_decode(value);
+
+        if ((used = varint_get(&flash_log_buffer[pos], len - pos, &value)) == 0)
+            return 0;
+        pos += used;
+        temperature[sample.sensor] += zigzag_decode(value);
+
+        sample.humidity = humidity[sample.sensor];
+        sample.temperature = temperature[sample.sensor];
+        ctx->ret = ctx->cb(&sample, ctx->user_data);
+        if (ctx->ret != 0)
+            return 1;  // stops fcb_walk()
+    }
+
+    return 0;
+}
+
+int flash_log_walk(flash_log_cb_t cb, void *user_data) {
+    struct flash_log_walk_ctx ctx = {.cb = cb, .user_data = user_data};
+
+    const int err = fcb_walk(&flash_log_fcb, NULL, flash_log_decode, &ctx);
+
+    return ctx.ret != 0 ? ctx.ret : err;
+}
@@ -0,0 +1,69 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <stdint.h>
+
+#include "sample_ring.h"
+
+/*
+ * Circular log of HTS221 samples in flash, on top of the flash circular buffer (FCB).
+ *
+ * Samples are encoded in RAM into records of up to CONFIG_SAMPLE_FLASH_LOG_RECORD_SAMPLES samples, and every full
+ * record is appended to the FCB with a single write. When the log is full the oldest sector is erased, so the sectors
+ * are written and erased in turn. Inside a record, timestamps and raw words are stored as zigzag varint deltas from the
+ * previous sample (of the same sensor, for the raw words).
+ */
+
+/**
+ * @brief One sample decoded from the flash log.
+ */
+struct flash_log_sample {
+    uint32_t record;       // sequence number of the record, increasing across reboots
+    int64_t uptime_ms;     // k_uptime_get() of the sample, relative to the boot that wrote the record
+    uint8_t sensor;        // index in hts221_devs[]
+    uint16_t humidity;     // raw HUMIDITY_OUT word
+    uint16_t temperature;  // raw TEMP_OUT word
+};
+
+/**
+ * @brief Called for every sample by flash_log_walk().
+ *
+ * @return 0 to continue the walk, any other value to stop it.
+ */
+typedef int (*flash_log_cb_t)(const struct flash_log_sample *sample, void *user_data);
+
+/**
+ * @brief Opens the log partition and finds the last record written.
+ *
+ * @return 0 on success, otherwise a value from the flash map or FCB API.
+ */
+int flash_log_init(void);
+
+/**
+ * @brief Adds one sample to the current record, and appends the record to flash when it is full.
+ *
+ * @param sample Sample taken from the sample ring, shortly before the call.
+ * @return 0 on success, otherwise a value from flash_log_flush().
+ */
+int flash_log_add(const struct sample *sample);
+
+/**
+ * @brief Appends the current record to flash, even if it is not full.
+ *
+ * @return 0 on success, otherwise a value from the FCB API.
+ */
+int flash_log_flush(void);
+
+/**
+ * @brief Decodes all the samples in flash, from the oldest, one record at a time.
+ *
+ * @details Only one record at a time is held in RAM. Not reentrant, and to be called from the thread that adds the
+ * samples.
+ *
+ * @param cb Callback called for every sample.
+ * @param user_data Pointer passed to cb.
+ * @return 0 on success, the value returned by cb if it stops the walk, or a value from the FCB API.
+ */
+int flash_log_walk(flash_log_cb_t cb, void *user_data);
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Host microbenchmark of the HTS221 fixed-point conversion: scalar (one call per sample) vs hts221_convert_batch().
+ * Built and run with `make bench_convert`, outside Zephyr.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hts221_convert.h"
+
+#define BENCH_SAMPLES 4096
+#define BENCH_ROUNDS 20000
+#define BENCH_CHECK_CALIBRATIONS 10000
+
+static int16_t temp_raw[BENCH_SAMPLES];
+static int16_t humidity_raw[BENCH_SAMPLES];
+static int32_t temperature[BENCH_SAMPLES];
+static int32_t humidity[BENCH_SAMPLES];
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Compares the batch and scalar conversions on every 10-bit raw word with random calibrations.
+ */
+static int check_batch(void) {
+    int16_t raw[1024];
+    int32_t t_batch[1024], rh_batch[1024];
+    const struct hts221_raw_batch in = {.temp_raw = raw, .humidity_raw = raw};
+    struct hts221_milli_batch out = {.temperature = t_batch, .humidity = rh_batch};
+
+    for (int i = 0; i < 1024; i++)
+        raw[i] = i;
+
+    for (int c = 0; c < BENCH_CHECK_CALIBRATIONS; c++) {
+        const struct Hts221_calibration_coeff calibration = {
+            .t0_milli = (rand() % 1024) * 125,
+            .t_slope_q16 = (rand() % (1 << 24)) - (1 << 23),
+            .t0_out = (int16_t)rand(),
+            .rh0_milli = (rand() % 256) * 500,
+            .rh_slope_q16 = (rand() % (1 << 24)) - (1 << 23),
+            .h0_out = (int16_t)rand(),
+        };
+
+        hts221_convert_batch(&calibration, &in, 1024, &out);
+        for (int i = 0; i < 1024; i++) {
+            if (t_batch[i] != hts221_calib_temperature_milli(&calibration, raw[i]) ||
+                rh_batch[i] != hts221_calib_humidity_milli(&calibration, raw[i])) {
+                printf("mismatch: raw = %d, calibration %d\n", i, c);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(void) {
+    // Calibration of the native_sim emulator: 20 degC -> 300, 35 degC -> 700, 33 %RH -> 200, 75 %RH -> 800
+    const struct Hts221_calibration_coeff calibration = {
+        .t0_milli = 20000,
+        .t_slope_q16 = (int32_t)(((int64_t)120 * 125 << 16) / 400),
+        .t0_out = 300,
+        .rh0_milli = 33000,
+        .rh_slope_q16 = (int32_t)(((int64_t)84 * 500 << 16) / 600),
+        .h0_out = 200,
+    };
+    const struct hts221_raw_batch in = {.temp_raw = temp_raw, .humidity_raw = humidity_raw};
+    struct hts221_milli_batch out = {.temperature = temperature, .humidity = humidity};
+    int64_t checksum = 0;
+
+    if (check_batch() != 0)
+        return 1;
+
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        temp_raw[i] = rand() & 0x3ff;
+        humidity_raw[i] = rand() & 0x3ff;
+    }
+
+    double start = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            temperature[i] = hts221_calib_temperature_milli(&calibration, temp_raw[i]);
+            humidity[i] = hts221_calib_humidity_milli(&calibration, humidity_raw[i]);
+        }
+        checksum += temperature[r % BENCH_SAMPLES] + humidity[r % BENCH_SAMPLES];
+    }
+    const double scalar_s = now_s() - start;
+
+    start = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        hts221_convert_batch(&calibration, &in, BENCH_SAMPLES, &out);
+        checksum -= temperature[r % BENCH_SAMPLES] + humidity[r % BENCH_SAMPLES];
+    }
+    const double batch_s = now_s() - start;
+
+    const double samples = (double)BENCH_SAMPLES * BENCH_ROUNDS;
+    printf("HTS221 conversion, %d x %d samples (checksum %" PRId64 ")\n", BENCH_ROUNDS, BENCH_SAMPLES, checksum);
+    printf("\tscalar: %8.1f Msamples/s\n", samples / scalar_s * 1e-6);
+    printf("\tbatch:  %8.1f Msamples/s (x%.1f)\n", samples / batch_s * 1e-6, scalar_s / batch_s);
+
+    return checksum != 0;
+}
@@ -0,0 +1,172 @@
+/*
+ * Host accuracy check of the HTS221 conversions: the calibration block is decoded by hts221_calibration_from_raw(),
+ * then the fixed point (hts221_calib_*_milli()) and single precision float (hts221_calib_*()) conversions are compared
+ * against the exact calibration line, over every 16-bit raw word. Fails when the error exceeds the bounds documented
+ * with hts221_convert_temperature_milli(). Built and run with `make check_convert`, outside Zephyr.
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hts221_convert.h"
+
+#define CHECK_FIXED_BOUND_MILLI 1.1
+#define CHECK_FLOAT_BOUND_MILLI 4.0
+#define CHECK_RANDOM_CALIBRATIONS 1000
+
+/**
+ * @brief Reference points of a calibration, as stored in CALIB_0..CALIB_F.
+ */
+struct check_calibration {
+    uint8_t h0_rh_x2;
+    uint8_t h1_rh_x2;
+    uint16_t t0_degc_x8;  // 10 bits
+    uint16_t t1_degc_x8;
+    int16_t h0_t0_out;
+    int16_t h1_t0_out;
+    int16_t t0_out;
+    int16_t t1_out;
+};
+
+struct check_error {
+    double fixed;
+    double single;
+    int32_t fixed_raw;
+    int32_t single_raw;
+};
+
+/**
+ * @brief Builds the CALIB_0..CALIB_F block of a calibration, following the register map of the datasheet.
+ */
+static void check_calib_block(const struct check_calibration *c, uint8_t block[HTS221_CALIB_SIZE]) {
+    block[0] = c->h0_rh_x2;
+    block[1] = c->h1_rh_x2;
+    block[2] = c->t0_degc_x8 & 0xff;
+    block[3] = c->t1_degc_x8 & 0xff;
+    block[4] = 0;
+    block[5] = (c->t0_degc_x8 >> 8 & 0b11) | (c->t1_degc_x8 >> 8 & 0b11) << 2;
+    block[6] = c->h0_t0_out & 0xff;
+    block[7] = (uint16_t)c->h0_t0_out >> 8;
+    block[8] = 0;
+    block[9] = 0;
+    block[10] = c->h1_t0_out & 0xff;
+    block[11] = (uint16_t)c->h1_t0_out >> 8;
+    block[12] = c->t0_out & 0xff;
+    block[13] = (uint16_t)c->t0_out >> 8;
+    block[14] = c->t1_out & 0xff;
+    block[15] = (uint16_t)c->t1_out >> 8;
+}
+
+static void check_update(struct check_error *error, const int32_t raw, const double exact, const int32_t fixed,
+                         const float single) {
+    const double fixed_error = fabs(fixed - exact);
+    const double single_error = fabs(single * 1000.0 - exact);
+
+    if (fixed_error > error->fixed) {
+        error->fixed = fixed_error;
+        error->fixed_raw = raw;
+    }
+    if (single_error > error->single) {
+        error->single = single_error;
+        error->single_raw = raw;
+    }
+}
+
+/**
+ * @brief Sweeps every raw word through the driver conversions of a calibration and keeps the worst errors.
+ *
+ * @return 0, or 1 if the driver rejected the calibration block.
+ */
+static int check_calibration(const struct check_calibration *c, struct check_error *temperature,
+                             struct check_error *humidity) {
+    uint8_t block[HTS221_CALIB_SIZE];
+    struct Hts221_calibration_coeff calibration;
+
+    check_calib_block(c, block);
+    if (hts221_calibration_from_raw(&calibration, block) != 0) {
+        printf("calibration block rejected\n");
+        return 1;
+    }
+
+    // Exact lines, from the reference points rather than from the decoded coefficients
+    const double t_slope = 125.0 * (c->t1_degc_x8 - c->t0_degc_x8) / (c->t1_out - c->t0_out);
+    const double rh_slope = 500.0 * (c->h1_rh_x2 - c->h0_rh_x2) / (c->h1_t0_out - c->h0_t0_out);
+
+    for (int32_t raw = INT16_MIN; raw <= INT16_MAX; raw++) {
+        check_update(temperature, raw, 125.0 * c->t0_degc_x8 + (raw - c->t0_out) * t_slope,
+                     hts221_calib_temperature_milli(&calibration, (int16_t)raw),
+                     hts221_calib_temperature(&calibration, (int16_t)raw));
+        check_update(humidity, raw, 500.0 * c->h0_rh_x2 + (raw - c->h0_t0_out) * rh_slope,
+                     hts221_calib_humidity_milli(&calibration, (int16_t)raw),
+                     hts221_calib_humidity(&calibration, (int16_t)raw));
+    }
+
+    return 0;
+}
+
+static int check_report(const char *name, const char *unit, const struct check_error *error) {
+    printf("\t%s, max error: fixed point %.3f milli-%s (raw %d), float %.3f milli-%s (raw %d)\n", name, error->fixed,
+           unit, error->fixed_raw, error->single, unit, error->single_raw);
+
+    if (error->fixed > CHECK_FIXED_BOUND_MILLI || error->single > CHECK_FLOAT_BOUND_MILLI) {
+        printf("%s: above the documented bounds (%.1f fixed point, %.1f float)\n", name, CHECK_FIXED_BOUND_MILLI,
+               CHECK_FLOAT_BOUND_MILLI);
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Random calibration in the range of real sensors: 10..50 degC and 20..80 %RH reference points, 100..2000 LSB
+ * apart, with either slope sign.
+ */
+static struct check_calibration check_random_calibration(void) {
+    struct check_calibration c = {
+        .h0_rh_x2 = 40 + rand() % 40,
+        .t0_degc_x8 = 80 + rand() % 160,
+        .h0_t0_out = rand() % 4000 - 2000,
+        .t0_out = rand() % 4000 - 2000,
+    };
+
+    c.h1_rh_x2 = c.h0_rh_x2 + 60 + rand() % 60;
+    c.t1_degc_x8 = c.t0_degc_x8 + 80 + rand() % 160;
+    c.h1_t0_out = c.h0_t0_out + (100 + rand() % 1900) * (rand() % 2 ? 1 : -1);
+    c.t1_out = c.t0_out + (100 + rand() % 1900) * (rand() % 2 ? 1 : -1);
+
+    return c;
+}
+
+int main(void) {
+    // Calibration of the native_sim emulator: 20 degC -> 300, 35 degC -> 700, 33 %RH -> 200, 75 %RH -> 800
+    const struct check_calibration emulator = {
+        .h0_rh_x2 = 66,
+        .h1_rh_x2 = 150,
+        .t0_degc_x8 = 160,
+        .t1_degc_x8 = 280,
+        .h0_t0_out = 200,
+        .h1_t0_out = 800,
+        .t0_out = 300,
+        .t1_out = 700,
+    };
+    struct check_error temperature = {0}, humidity = {0};
+    int failed = check_calibration(&emulator, &temperature, &humidity);
+
+    printf("Emulator calibration:\n");
+    failed |= check_report("temperature", "degC", &temperature);
+    failed |= check_report("humidity", "%RH", &humidity);
+
+    temperature = (struct check_error){0};
+    humidity = (struct check_error){0};
+    for (int i = 0; i < CHECK_RANDOM_CALIBRATIONS; i++) {
+        const struct check_calibration c = check_random_calibration();
+        failed |= check_calibration(&c, &temperature, &humidity);
+    }
+
+    printf("%d random calibrations:\n", CHECK_RANDOM_CALIBRATIONS);
+    failed |= check_report("temperature", "degC", &temperature);
+    failed |= check_report("humidity", "%RH", &humidity);
+
+    return failed;
+}
@@ -0,0 +1,338 @@
+#define DT_DRV_COMPAT st_hts221
+
+#include "hts221_emul.h"
+
+#include <string.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "hts221.h"
+
+#define HTS221_EMUL_REG_COUNT 0x40
+#define HTS221_EMUL_CONVERSION_US 3000  // one-shot conversion time with the default averaging
+#define HTS221_EMUL_STATUS_DA (HTS221_STATUS_REG_H_DA | HTS221_STATUS_REG_T_DA)
+
+struct hts221_emul_cfg {
+    struct gpio_dt_spec drdy;
+};
+
+struct hts221_emul_data {
+    const struct hts221_emul_cfg *cfg;
+    uint8_t regs[HTS221_EMUL_REG_COUNT];
+    int16_t humidity_raw;
+    int16_t temp_raw;
+    struct k_timer conversion_timer;
+    uint32_t odr_period_us;   // override of the ODR period, 0 when unused
+    uint32_t conversion_cyc;  // k_cycle_get_32() at the end of the last conversion
+    struct hts221_emul_stats stats;
+    enum hts221_emul_fault fault;
+    uint32_t fault_count;
+    struct k_spinlock lock;
+};
+
+/*
+ * Factory calibration of a sample sensor: 20 degC -> 300 LSB, 35 degC -> 700 LSB, 33 %RH -> 200 LSB,
+ * 75 %RH -> 800 LSB. Offsets are relative to CALIB_0 (0x30), as in the HTS221 datasheet.
+ */
+static const uint8_t hts221_emul_calib[16] = {
+    66,          // H0_rH_x2
+    150,         // H1_rH_x2
+    160,         // T0_degC_x8
+    0x18,        // T1_degC_x8 (LSB of 280)
+    0x00,        // reserved
+    0x04,        // T1/T0 msb
+    200,  0x00,  // H0_T0_OUT
+    0x00, 0x00,  // reserved
+    0x20, 0x03,  // H1_T0_OUT = 800
+    0x2c, 0x01,  // T0_OUT = 300
+    0xbc, 0x02,  // T1_OUT = 700
+};
+
+static void hts221_emul_update_drdy(struct hts221_emul_data *data) {
+    const uint8_t ctrl_reg3 = data->regs[HTS221_CTRL_REG3];
+    const bool data_available = (data->regs[HTS221_STATUS_REG] & HTS221_EMUL_STATUS_DA) != 0;
+    const bool active = (ctrl_reg3 & HTS221_CTRL_REG3_DRDY_EN) && data_available;
+    const bool active_low = (ctrl_reg3 & HTS221_CTRL_REG3_DRDY_H_L) != 0;
+
+    gpio_emul_input_set(data->cfg->drdy.port, data->cfg->drdy.pin, active != active_low);
+}
+
+static void hts221_emul_conversion_done(struct k_timer *timer) {
+    struct hts221_emul_data *data = CONTAINER_OF(timer, struct hts221_emul_data, conversion_timer);
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    sys_put_le16(data->humidity_raw, &data->regs[HTS221_HUMIDITY_OUT_L]);
+    sys_put_le16(data->temp_raw, &data->regs[HTS221_TEMP_OUT_L]);
+    data->regs[HTS221_STATUS_REG] |= HTS221_EMUL_STATUS_DA;
+    data->regs[HTS221_CTRL_REG2] &= ~HTS221_CTRL_REG2_ONE_SHOT;
+    data->stats.conversions++;
+    data->conversion_cyc = k_cycle_get_32();
+
+    k_spin_unlock(&data->lock, key);
+    hts221_emul_update_drdy(data);
+}
+
+static k_timeout_t hts221_emul_odr_period(const struct hts221_emul_data *data, const uint8_t odr) {
+    if (data->odr_period_us != 0)
+        return K_USEC(data->odr_period_us);
+
+    switch (odr) {
+        case HTS221_ODR_1_HZ:
+            return K_MSEC(1000);
+        case HTS221_ODR_7_HZ:
+            return K_USEC(142857);
+        case HTS221_ODR_12_5_HZ:
+            return K_MSEC(80);
+        default:
+            return K_NO_WAIT;
+    }
+}
+
+static void hts221_emul_write_reg(struct hts221_emul_data *data, const uint8_t reg, const uint8_t value) {
+    switch (reg) {
+        case HTS221_AV_CONF:
+        case HTS221_CTRL_REG3:
+            data->regs[reg] = value;
+            break;
+        case HTS221_CTRL_REG1: {
+            data->regs[reg] = value;
+            const uint8_t odr = value & HTS221_CTRL_REG1_ODR;
+            if ((value & HTS221_CTRL_REG1_PD) && odr != HTS221_ODR_ONE_SHOT) {
+                const k_timeout_t period = hts221_emul_odr_period(data, odr);
+                k_timer_start(&data->conversion_timer, period, period);
+            } else {
+                k_timer_stop(&data->conversion_timer);
+            }
+            break;
+        }
+        case HTS221_CTRL_REG2:
+            data->regs[reg] = value & ~HTS221_CTRL_REG2_BOOT;  // the reboot of the memory content completes immediately
+            if ((value & HTS221_CTRL_REG2_ONE_SHOT) && (data->regs[HTS221_CTRL_REG1] & HTS221_CTRL_REG1_PD)) {
+                k_timer_start(&data->conversion_timer, K_USEC(HTS221_EMUL_CONVERSION_US), K_NO_WAIT);
+            }
+            break;
+        default:
+            if (reg >= HTS221_CALIB_0) {
+                data->regs[reg] = value;
+            }
+            break;  // writes to read-only registers are ignored
+    }
+}
+
+static uint8_t hts221_emul_read_reg(struct hts221_emul_data *data, const uint8_t reg) {
+    const uint8_t value = data->regs[reg];
+
+    if (reg == HTS221_HUMIDITY_OUT_H) {
+        data->regs[HTS221_STATUS_REG] &= ~HTS221_STATUS_REG_H_DA;
+    } else if (reg == HTS221_TEMP_OUT_H) {
+        data->regs[HTS221_STATUS_REG] &= ~HTS221_STATUS_REG_T_DA;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Returns the error of the injected fault that applies to a transfer, or 0.
+ */
+static int hts221_emul_fault_error(struct hts221_emul_data *data, const uint8_t reg, const int num_msgs) {
+    int err;
+
+    switch (data->fault) {
+        case HTS221_EMUL_FAULT_NACK:
+            err = -EIO;
+            break;
+        case HTS221_EMUL_FAULT_TIMEOUT:
+            err = -ETIMEDOUT;
+            break;
+        case HTS221_EMUL_FAULT_STUCK_DRDY:
+            err = (num_msgs == 2 && reg == HTS221_HUMIDITY_OUT_L) ? -EIO : 0;
+            break;
+        default:
+            err = 0;
+            break;
+    }
+    if (err == 0)
+        return 0;
+
+    data->stats.faults++;
+    if (--data->fault_count == 0)
+        data->fault = HTS221_EMUL_FAULT_NONE;
+
+    return err;
+}
+
+static int hts221_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs, int addr) {
+    ARG_UNUSED(addr);
+    struct hts221_emul_data *data = target->data;
+
+    if (num_msgs < 1 || num_msgs > 2 || (msgs[0].flags & I2C_MSG_READ) || msgs[0].len < 1) {
+        return -EIO;
+    }
+
+    const bool auto_increment = (msgs[0].buf[0] & HTS221_MULTIPLE_BYTES_READ) != 0;
+    uint8_t reg = msgs[0].buf[0] & ~HTS221_MULTIPLE_BYTES_READ;
+
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    const bool had_data = (data->regs[HTS221_STATUS_REG] & HTS221_EMUL_STATUS_DA) != 0;
+
+    const int fault_err = hts221_emul_fault_error(data, reg, num_msgs);
+    if (fault_err != 0) {
+        k_spin_unlock(&data->lock, key);
+        return fault_err;
+    }
+
+    data->stats.transfers++;
+    data->stats.bytes += msgs[0].len;
+
+    for (uint32_t i = 1; i < msgs[0].len; i++) {
+        if (reg >= HTS221_EMUL_REG_COUNT) {
+            k_spin_unlock(&data->lock, key);
+            return -EIO;
+        }
+        hts221_emul_write_reg(data, reg, msgs[0].buf[i]);
+        reg = auto_increment ? reg + 1 : reg;
+    }
+
+    if (num_msgs == 2) {
+        if (!(msgs[1].flags & I2C_MSG_READ)) {
+            k_spin_unlock(&data->lock, key);
+            return -EIO;
+        }
+        data->stats.bytes += msgs[1].len;
+
+        for (uint32_t i = 0; i < msgs[1].len; i++) {
+            if (reg >= HTS221_EMUL_REG_COUNT) {
+                k_spin_unlock(&data->lock, key);
+                return -EIO;
+            }
+            msgs[1].buf[i] = hts221_emul_read_reg(data, reg);
+            reg = auto_increment ? reg + 1 : reg;
+        }
+    }
+
+    const bool has_data = (data->regs[HTS221_STATUS_REG] & HTS221_EMUL_STATUS_DA) != 0;
+    if (had_data && !has_data) {
+        data->stats.samples_read++;
+        data->stats.last_read_cyc = k_cycle_get_32();
+        data->stats.max_read_cyc = MAX(data->stats.max_read_cyc, data->stats.last_read_cyc - data->conversion_cyc);
+    }
+
+    k_spin_unlock(&data->lock, key);
+
+    /* DRDY follows STATUS_REG and CTRL_REG3, both of which may have changed in this transfer. */
+    hts221_emul_update_drdy(data);
+
+    return 0;
+}
+
+static const struct i2c_emul_api hts221_emul_api_i2c = {
+    .transfer = hts221_emul_transfer,
+};
+
+/**
+ * @brief Sets the registers to their reset value and reloads the calibration, as at power-on.
+ */
+static void hts221_emul_reset_regs(struct hts221_emul_data *data) {
+    memset(data->regs, 0, sizeof(data->regs));
+    data->regs[HTS221_WHO_AM_I] = HTS221_WHO_AM_I_VALUE;
+    data->regs[HTS221_AV_CONF] = 0x1b;  // reset value from the datasheet
+    memcpy(&data->regs[HTS221_CALIB_0], hts221_emul_calib, sizeof(hts221_emul_calib));
+}
+
+static int hts221_emul_init(const struct emul *target, const struct device *parent) {
+    ARG_UNUSED(parent);
+    struct hts221_emul_data *data = target->data;
+
+    data->cfg = target->cfg;
+    hts221_emul_reset_regs(data);
+
+    data->humidity_raw = 500;
+    data->temp_raw = 500;
+
+    k_timer_init(&data->conversion_timer, hts221_emul_conversion_done, NULL);
+
+    if (!device_is_ready(data->cfg->drdy.port)) {
+        return -ENODEV;
+    }
+
+    return gpio_emul_input_set(data->cfg->drdy.port, data->cfg->drdy.pin, 0);
+}
+
+void hts221_emul_set_raw(const struct emul *target, int16_t humidity_raw, int16_t temp_raw) {
+    struct hts221_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    data->humidity_raw = humidity_raw;
+    data->temp_raw = temp_raw;
+
+    k_spin_unlock(&data->lock, key);
+}
+
+void hts221_emul_set_odr_period(const struct emul *target, const uint32_t period_us) {
+    struct hts221_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    data->odr_period_us = period_us;
+    const uint8_t ctrl_reg1 = data->regs[HTS221_CTRL_REG1];
+    const uint8_t odr = ctrl_reg1 & HTS221_CTRL_REG1_ODR;
+    if ((ctrl_reg1 & HTS221_CTRL_REG1_PD) && odr != HTS221_ODR_ONE_SHOT) {
+        const k_timeout_t period = hts221_emul_odr_period(data, odr);
+        k_timer_start(&data->conversion_timer, period, period);
+    }
+
+    k_spin_unlock(&data->lock, key);
+}
+
+void hts221_emul_get_stats(const struct emul *target, struct hts221_emul_stats *stats) {
+    struct hts221_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    *stats = data->stats;
+
+    k_spin_unlock(&data->lock, key);
+}
+
+void hts221_emul_reset_stats(const struct emul *target) {
+    struct hts221_emul_data *data = target->data;
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    memset(&data->stats, 0, sizeof(data->stats));
+
+    k_spin_unlock(&data->lock, key);
+}
+
+void hts221_emul_inject_fault(const struct emul *target, const enum hts221_emul_fault fault, const uint32_t count) {
+    struct hts221_emul_data *data = target->data;
+
+    if (fault == HTS221_EMUL_FAULT_BROWNOUT) {
+        k_timer_stop(&data->conversion_timer);
+        k_spinlock_key_t key = k_spin_lock(&data->lock);
+        hts221_emul_reset_regs(data);
+        k_spin_unlock(&data->lock, key);
+        hts221_emul_update_drdy(data);
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+    data->fault = count > 0 ? fault : HTS221_EMUL_FAULT_NONE;
+    data->fault_count = count;
+
+    k_spin_unlock(&data->lock, key);
+}
+
+#define HTS221_EMUL_DEFINE(n)                                                                                 \
+    static const struct hts221_emul_cfg hts221_emul_cfg_##n = {                                               \
+        .drdy = GPIO_DT_SPEC_INST_GET(n, drdy_gpios),                                                         \
+    };                                                                                                        \
+    static struct hts221_emul_data hts221_emul_data_##n;                                                      \
+    EMUL_DT_INST_DEFINE(n, hts221_emul_init, &hts221_emul_data_##n, &hts221_emul_cfg_##n, &hts221_emul_api_i2c, \
+                        NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(HTS221_EMUL_DEFINE)
@@ -0,0 +1,75 @@
+#ifndef HTS221_EMUL_H
+#define HTS221_EMUL_H
+
+#include <stdint.h>
+#include <zephyr/drivers/emul.h>
+
+/**
+ * @brief Counters collected by the HTS221 emulator for every I2C transfer it serves.
+ */
+struct hts221_emul_stats {
+    uint32_t transfers;      // number of i2c_transfer() calls addressed to the sensor
+    uint32_t bytes;          // payload bytes moved on the bus, register address included
+    uint32_t conversions;    // completed one-shot or ODR conversions
+    uint32_t samples_read;   // conversions fully read back (both HUMIDITY_OUT_H and TEMP_OUT_H)
+    uint32_t last_read_cyc;  // k_cycle_get_32() value when the last sample was fully read
+    uint32_t max_read_cyc;   // longest time from the end of a conversion to its complete read, in cycles
+    uint32_t faults;         // transfers failed by an injected fault
+};
+
+/**
+ * @brief Faults injected by hts221_emul_inject_fault().
+ */
+enum hts221_emul_fault {
+    HTS221_EMUL_FAULT_NONE,
+    HTS221_EMUL_FAULT_NACK,        // transfers fail with -EIO, as if the sensor did not acknowledge
+    HTS221_EMUL_FAULT_TIMEOUT,     // transfers fail with -ETIMEDOUT, as if the bus was stuck
+    HTS221_EMUL_FAULT_STUCK_DRDY,  // reads of the output registers fail, so DRDY stays asserted
+    HTS221_EMUL_FAULT_BROWNOUT,    // the registers return to their reset value, configuration lost
+};
+
+/**
+ * @brief Sets the raw humidity and temperature words latched by the next conversion.
+ *
+ * @param target HTS221 emulator instance.
+ * @param humidity_raw Raw value for HUMIDITY_OUT_L/H.
+ * @param temp_raw Raw value for TEMP_OUT_L/H.
+ */
+void hts221_emul_set_raw(const struct emul *target, int16_t humidity_raw, int16_t temp_raw);
+
+/**
+ * @brief Overrides the period of the continuous conversions, to drive DRDY faster than the ODR allows.
+ *
+ * @details Applies immediately when the sensor converts continuously, and to the next continuous mode otherwise.
+ *
+ * @param target HTS221 emulator instance.
+ * @param period_us Conversion period in us, 0 to follow the ODR of CTRL_REG1 again.
+ */
+void hts221_emul_set_odr_period(const struct emul *target, const uint32_t period_us);
+
+/**
+ * @brief Copies the current bus and conversion counters.
+ *
+ * @param target HTS221 emulator instance.
+ * @param stats Pointer to the structure that stores the counters.
+ */
+void hts221_emul_get_stats(const struct emul *target, struct hts221_emul_stats *stats);
+
+/**
+ * @brief Clears all the bus and conversion counters.
+ *
+ * @param target HTS221 emulator instance.
+ */
+void hts221_emul_reset_stats(const struct emul *target);
+
+/**
+ * @brief Injects a fault in the next transfers addressed to the sensor.
+ *
+ * @param target HTS221 emulator instance.
+ * @param fault Fault to inject. HTS221_EMUL_FAULT_BROWNOUT applies immediately, HTS221_EMUL_FAULT_NONE clears the
+ * pending faults.
+ * @param count Number of transfers to fail.
+ */
+void hts221_emul_inject_fault(const struct emul *target, const enum hts221_emul_fault fault, const uint32_t count);
+
+#endif
@@ -1,263 +1,534 @@
 #include "hts221.h"
 
-struct Hts221_calibration_coeff {
-    // Temperature
-    float t_m;
-    float t_q;
+#define DT_DRV_COMPAT st_hts221
 
-    // Humidity
-    float rh_m;
-    float rh_q;
-};
+#define HTS221_DEV_INIT(n)                                    \
+    [n] = {                                                   \
+        .i2c = I2C_DT_SPEC_INST_GET(n),                       \
+        .drdy = GPIO_DT_SPEC_INST_GET_OR(n, drdy_gpios, {0}), \
+    },
 
-static struct Hts221_calibration_coeff calibration_coeff;
+struct hts221_dev hts221_devs[HTS221_DEV_COUNT] = {DT_INST_FOREACH_STATUS_OKAY(HTS221_DEV_INIT)};
 
-int hts221_read_whoami(const struct i2c_dt_spec *spec, uint8_t *read_buf) {
-    return i2c_reg_read_byte_dt(spec, HTS221_WHO_AM_I, read_buf);
+/**
+ * @brief Updates the bus statistics of the device and passes the error code through.
+ */
+static int hts221_stat_transfer(struct hts221_dev *dev, const int err) {
+    dev->stats.transfers++;
+    if (err != 0)
+        dev->stats.errors++;
+
+    return err;
+}
+
+/**
+ * @brief Updates the active time counters of the device after CTRL_REG1 is written or read.
+ */
+static void hts221_power_update(struct hts221_dev *dev, const uint8_t ctrl_reg1) {
+    const bool active = (ctrl_reg1 & HTS221_CTRL_REG1_PD) != 0;
+    if (active == dev->power.active)
+        return;
+
+    const int64_t now = k_uptime_get();
+    if (active)
+        dev->power.active_since = now;
+    else
+        dev->power.active_ms += now - dev->power.active_since;
+    dev->power.active = active;
+}
+
+/**
+ * @brief Returns the shadow copy of a configuration register, or NULL if the register is not cached.
+ */
+static uint8_t *hts221_shadow_reg(struct hts221_dev *dev, const hts221_reg_t reg) {
+    switch (reg) {
+        case HTS221_AV_CONF:
+            return &dev->shadow.av_conf;
+        case HTS221_CTRL_REG1:
+            return &dev->shadow.ctrl_reg1;
+        case HTS221_CTRL_REG2:
+            return &dev->shadow.ctrl_reg2;
+        case HTS221_CTRL_REG3:
+            return &dev->shadow.ctrl_reg3;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Reads a configuration register from the shadow copy, falling back to the bus until the copy is synced.
+ */
+static int hts221_cached_reg_read(struct hts221_dev *dev, const hts221_reg_t reg, uint8_t *value) {
+    const uint8_t *shadow = hts221_shadow_reg(dev, reg);
+    if (dev->shadow.valid && shadow != NULL) {
+        *value = *shadow;
+        return 0;
+    }
+
+    return hts221_stat_transfer(dev, i2c_reg_read_byte_dt(&dev->i2c, reg, value));
+}
+
+/**
+ * @brief Writes a configuration register and updates its shadow copy on success.
+ *
+ * @details BOOT and ONE_SHOT in CTRL_REG2 are cleared by the sensor itself, so they are never stored in the shadow copy.
+ */
+static int hts221_cached_reg_write(struct hts221_dev *dev, const hts221_reg_t reg, const uint8_t value) {
+    const int err = hts221_stat_transfer(dev, i2c_reg_write_byte_dt(&dev->i2c, reg, value));
+    if (err != 0)
+        return err;
+
+    uint8_t *shadow = hts221_shadow_reg(dev, reg);
+    if (shadow != NULL)
+        *shadow = (reg == HTS221_CTRL_REG2) ? (value & ~(HTS221_CTRL_REG2_BOOT | HTS221_CTRL_REG2_ONE_SHOT)) : value;
+    if (reg == HTS221_CTRL_REG1)
+        hts221_power_update(dev, value);
+
+    return 0;
+}
+
+int hts221_read_whoami(struct hts221_dev *dev, uint8_t *read_buf) {
+    return hts221_stat_transfer(dev, i2c_reg_read_byte_dt(&dev->i2c, HTS221_WHO_AM_I, read_buf));
 }
 
 /************************
  * Sensor Configuration *
  ************************/
 
-int hts221_read_av_conf(const struct i2c_dt_spec *spec, hts221_av_conf_t *temp_conf, hts221_av_conf_t *humidity_conf) {
+int hts221_sync_shadow_regs(struct hts221_dev *dev) {
+    dev->shadow.valid = false;
+
+    int err = hts221_stat_transfer(dev, i2c_reg_read_byte_dt(&dev->i2c, HTS221_AV_CONF, &dev->shadow.av_conf));
+    if (err != 0)
+        return err;
+
+    const hts221_reg_t reg = HTS221_CTRL_REG1 | HTS221_MULTIPLE_BYTES_READ;
+    uint8_t buffer[3];
+    err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, 3));
+    if (err != 0)
+        return err;
+
+    dev->shadow.ctrl_reg1 = buffer[0];
+    dev->shadow.ctrl_reg2 = buffer[1] & ~(HTS221_CTRL_REG2_BOOT | HTS221_CTRL_REG2_ONE_SHOT);
+    dev->shadow.ctrl_reg3 = buffer[2];
+    dev->shadow.valid = true;
+    hts221_power_update(dev, buffer[0]);
+
+    return 0;
+}
+
+int hts221_restore_config(struct hts221_dev *dev) {
+    if (!dev->shadow.valid)
+        return -ENODATA;
+
+    const struct {
+        hts221_reg_t reg;
+        uint8_t value;
+    } regs[] = {
+        {HTS221_AV_CONF, dev->shadow.av_conf},
+        {HTS221_CTRL_REG2, dev->shadow.ctrl_reg2},
+        {HTS221_CTRL_REG3, dev->shadow.ctrl_reg3},
+        {HTS221_CTRL_REG1, dev->shadow.ctrl_reg1},
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(regs); i++) {
+        const int err = hts221_stat_transfer(dev, i2c_reg_write_byte_dt(&dev->i2c, regs[i].reg, regs[i].value));
+        if (err != 0)
+            return err;
+    }
+
+    return 0;
+}
+
+int hts221_write_config(struct hts221_dev *dev, const struct Hts221_shadow_regs *config) {
+    dev->shadow.valid = false;
+
+    int err = hts221_stat_transfer(dev, i2c_reg_write_byte_dt(&dev->i2c, HTS221_AV_CONF, config->av_conf));
+    if (err != 0)
+        return err;
+
+    // CTRL_REG1 (0x20) to CTRL_REG3 (0x22) in a single auto-increment write message
+    const uint8_t buffer[4] = {
+        HTS221_CTRL_REG1 | HTS221_MULTIPLE_BYTES_READ,
+        config->ctrl_reg1,
+        config->ctrl_reg2,
+        config->ctrl_reg3,
+    };
+    err = hts221_stat_transfer(dev, i2c_write_dt(&dev->i2c, buffer, sizeof(buffer)));
+    if (err != 0)
+        return err;
+
+    dev->shadow = *config;
+    dev->shadow.valid = true;
+    hts221_power_update(dev, config->ctrl_reg1);
+
+    return 0;
+}
+
+int hts221_read_av_conf(struct hts221_dev *dev, hts221_av_conf_t *temp_conf, hts221_av_conf_t *humidity_conf) {
     uint8_t av_conf_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_AV_CONF, &av_conf_value);
+    int err = hts221_cached_reg_read(dev, HTS221_AV_CONF, &av_conf_value);
     if (err != 0)
         return err;
 
-    *temp_conf = (av_conf_value & 0b00111000) >> 3;
-    *humidity_conf = av_conf_value & 0b00000111;
+    *temp_conf = (av_conf_value & HTS221_AV_CONF_AVGT) >> 3;
+    *humidity_conf = av_conf_value & HTS221_AV_CONF_AVGH;
 
     return 0;
 }
 
-int hts221_set_av_conf(const struct i2c_dt_spec *spec, const hts221_av_conf_t temp_conf,
-                       const hts221_av_conf_t humidity_conf) {
-    return i2c_reg_write_byte_dt(spec, HTS221_AV_CONF, (temp_conf << 3) | humidity_conf);
+int hts221_set_av_conf(struct hts221_dev *dev, const hts221_av_conf_t temp_conf, const hts221_av_conf_t humidity_conf) {
+    return hts221_cached_reg_write(dev, HTS221_AV_CONF, (temp_conf << 3) | humidity_conf);
 }
 
-int hts221_enable(const struct i2c_dt_spec *spec) {
+int hts221_enable(struct hts221_dev *dev) {
     uint8_t ctrl_reg1_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, &ctrl_reg1_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG1, &ctrl_reg1_value);
     if (err != 0)
         return err;
 
-    return i2c_reg_write_byte_dt(spec, HTS221_CTRL_REG1, (ctrl_reg1_value & 0b01111111) | 0b10000000);
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG1, ctrl_reg1_value | HTS221_CTRL_REG1_PD);
 }
 
-int hts221_disable(const struct i2c_dt_spec *spec) {
+int hts221_disable(struct hts221_dev *dev) {
     uint8_t ctrl_reg1_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, &ctrl_reg1_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG1, &ctrl_reg1_value);
     if (err != 0)
         return err;
 
-    return i2c_reg_write_byte_dt(spec, HTS221_CTRL_REG1, ctrl_reg1_value & 0b01111111);
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG1, ctrl_reg1_value & ~HTS221_CTRL_REG1_PD);
 }
 
-int hts221_set_odr(const struct i2c_dt_spec *spec, const hts221_odr_config_t odr_conf) {
+int hts221_set_odr(struct hts221_dev *dev, const hts221_odr_config_t odr_conf) {
     uint8_t ctrl_reg1_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, &ctrl_reg1_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG1, &ctrl_reg1_value);
     if (err != 0)
         return err;
 
-    const uint8_t regs[2] = {HTS221_CTRL_REG1, (ctrl_reg1_value & 0b11111100) | odr_conf};
-    return i2c_write_dt(spec, regs, 2);
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG1, (ctrl_reg1_value & ~HTS221_CTRL_REG1_ODR) | odr_conf);
 }
 
-int hts221_read_odr(const struct i2c_dt_spec *spec, hts221_odr_config_t *odr_conf) {
+int hts221_read_odr(struct hts221_dev *dev, hts221_odr_config_t *odr_conf) {
     uint8_t ctrl_reg1_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, &ctrl_reg1_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG1, &ctrl_reg1_value);
     if (err != 0)
         return err;
 
-    *odr_conf = ctrl_reg1_value & 0b00000011;
+    *odr_conf = ctrl_reg1_value & HTS221_CTRL_REG1_ODR;
     return 0;
 }
 
-int hts221_set_bdu(const struct i2c_dt_spec *spec, const bool continuous_update) {
+int hts221_set_bdu(struct hts221_dev *dev, const bool continuous_update) {
     uint8_t ctrl_reg1_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, &ctrl_reg1_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG1, &ctrl_reg1_value);
     if (err != 0)
         return err;
 
-    const uint8_t bdu_mask = continuous_update ? 0b00000000 : 0b00000100;
+    const uint8_t bdu_mask = continuous_update ? 0 : HTS221_CTRL_REG1_BDU;
 
-    const uint8_t regs[2] = {HTS221_CTRL_REG1, (ctrl_reg1_value & 0b11111011) | bdu_mask};
-    return i2c_write_dt(spec, regs, 2);
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG1, (ctrl_reg1_value & ~HTS221_CTRL_REG1_BDU) | bdu_mask);
 }
 
-int hts221_read_bdu(const struct i2c_dt_spec *spec, bool *is_continuous_update) {
+int hts221_read_bdu(struct hts221_dev *dev, bool *is_continuous_update) {
     uint8_t ctrl_reg1_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, &ctrl_reg1_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG1, &ctrl_reg1_value);
     if (err != 0)
         return err;
 
-    *is_continuous_update = (ctrl_reg1_value & 0b00000100) ? false : true;
+    *is_continuous_update = (ctrl_reg1_value & HTS221_CTRL_REG1_BDU) ? false : true;
     return 0;
 }
 
-int hts221_set_heater_status(const struct i2c_dt_spec *spec, const bool enable) {
+int hts221_set_heater_status(struct hts221_dev *dev, const bool enable) {
     uint8_t ctrl_reg2_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG2, &ctrl_reg2_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG2, &ctrl_reg2_value);
     if (err != 0)
         return err;
 
-    const uint8_t heater_mask = enable ? 0b00000010 : 0b00000000;
+    const uint8_t heater_mask = enable ? HTS221_CTRL_REG2_HEATER : 0;
 
-    return i2c_reg_write_byte_dt(spec, HTS221_CTRL_REG2, (ctrl_reg2_value & 0b11111101) | heater_mask);
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG2, (ctrl_reg2_value & ~HTS221_CTRL_REG2_HEATER) | heater_mask);
 }
 
-int hts221_read_heater_status(const struct i2c_dt_spec *spec, bool *is_enabled) {
+int hts221_read_heater_status(struct hts221_dev *dev, bool *is_enabled) {
     uint8_t ctrl_reg2_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG2, &ctrl_reg2_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG2, &ctrl_reg2_value);
     if (err != 0)
         return err;
 
-    *is_enabled = (ctrl_reg2_value & 0b00000010) ? true : false;
+    *is_enabled = (ctrl_reg2_value & HTS221_CTRL_REG2_HEATER) ? true : false;
     return 0;
 }
 
-int hts221_trigger_one_shot(const struct i2c_dt_spec *spec) {
+int hts221_trigger_one_shot(struct hts221_dev *dev) {
     uint8_t ctrl_reg2_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG2, &ctrl_reg2_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG2, &ctrl_reg2_value);
     if (err != 0)
         return err;
 
-    return i2c_reg_write_byte_dt(spec, HTS221_CTRL_REG2, (ctrl_reg2_value & 0b11111110) | 0x1);
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG2, ctrl_reg2_value | HTS221_CTRL_REG2_ONE_SHOT);
 }
 
-int hts221_config_data_ready(const struct i2c_dt_spec *spec, const bool active_low) {
+int hts221_wake_one_shot(struct hts221_dev *dev) {
+    if (!dev->shadow.valid) {
+        const int err = hts221_enable(dev);
+        if (err != 0)
+            return err;
+        return hts221_trigger_one_shot(dev);
+    }
+
+    // CTRL_REG1 and CTRL_REG2 are contiguous: PD is set before ONE_SHOT within the same auto-increment write
+    const uint8_t buffer[3] = {
+        HTS221_CTRL_REG1 | HTS221_MULTIPLE_BYTES_READ,
+        dev->shadow.ctrl_reg1 | HTS221_CTRL_REG1_PD,
+        dev->shadow.ctrl_reg2 | HTS221_CTRL_REG2_ONE_SHOT,
+    };
+    const int err = hts221_stat_transfer(dev, i2c_write_dt(&dev->i2c, buffer, sizeof(buffer)));
+    if (err != 0)
+        return err;
+
+    dev->shadow.ctrl_reg1 = buffer[1];
+    hts221_power_update(dev, buffer[1]);
+
+    return 0;
+}
+
+void hts221_read_power_stats(const struct hts221_dev *dev, uint64_t *active_ms, uint64_t *idle_ms) {
+    const int64_t now = k_uptime_get();
+
+    *active_ms = dev->power.active_ms + (dev->power.active ? now - dev->power.active_since : 0);
+    *idle_ms = now - *active_ms;
+}
+
+int hts221_config_data_ready(struct hts221_dev *dev, const bool active_low) {
     uint8_t ctrl_reg3_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG3, &ctrl_reg3_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG3, &ctrl_reg3_value);
     if (err != 0)
         return err;
 
-    const uint8_t drdy_mask = active_low ? 0b10000000 : 0b00000000;
-    return i2c_reg_write_byte_dt(spec, HTS221_CTRL_REG3, (ctrl_reg3_value & 0b01111111) | drdy_mask);
+    const uint8_t drdy_mask = active_low ? HTS221_CTRL_REG3_DRDY_H_L : 0;
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG3, (ctrl_reg3_value & ~HTS221_CTRL_REG3_DRDY_H_L) | drdy_mask);
 }
 
-int hts221_enable_data_ready(const struct i2c_dt_spec *spec, const bool enable) {
+int hts221_enable_data_ready(struct hts221_dev *dev, const bool enable) {
     uint8_t ctrl_reg3_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG3, &ctrl_reg3_value);
+    int err = hts221_cached_reg_read(dev, HTS221_CTRL_REG3, &ctrl_reg3_value);
     if (err != 0)
         return err;
 
-    const uint8_t drdy_enable_mask = enable ? 0b00000100 : 0b00000000;
-    return i2c_reg_write_byte_dt(spec, HTS221_CTRL_REG3, (ctrl_reg3_value & 0b11111011) | drdy_enable_mask);
+    const uint8_t drdy_enable_mask = enable ? HTS221_CTRL_REG3_DRDY_EN : 0;
+    return hts221_cached_reg_write(dev, HTS221_CTRL_REG3,
+                                   (ctrl_reg3_value & ~HTS221_CTRL_REG3_DRDY_EN) | drdy_enable_mask);
 }
 
-int hts221_read_status(const struct i2c_dt_spec *spec, bool *new_humidity_available, bool *new_temp_available) {
+int hts221_read_status(struct hts221_dev *dev, bool *new_humidity_available, bool *new_temp_available) {
     uint8_t status_reg_value;
-    int err = i2c_reg_read_byte_dt(spec, HTS221_STATUS_REG, &status_reg_value);
+    int err = hts221_stat_transfer(dev, i2c_reg_read_byte_dt(&dev->i2c, HTS221_STATUS_REG, &status_reg_value));
     if (err != 0)
         return err;
 
-    *new_humidity_available = (status_reg_value & 0b00000010) >> 1;
-    *new_temp_available = status_reg_value & 0b00000001;
+    *new_humidity_available = (status_reg_value & HTS221_STATUS_REG_H_DA) >> 1;
+    *new_temp_available = status_reg_value & HTS221_STATUS_REG_T_DA;
     return 0;
 }
 
-int hts221_read_all_conf_reg(const struct i2c_dt_spec *spec, uint8_t *av_conf, uint8_t *ctrl_reg1, uint8_t *ctrl_reg2,
+int hts221_read_all_conf_reg(struct hts221_dev *dev, uint8_t *av_conf, uint8_t *ctrl_reg1, uint8_t *ctrl_reg2,
                              uint8_t *ctrl_reg3, uint8_t *status_reg) {
-    int err = i2c_reg_read_byte_dt(spec, HTS221_AV_CONF, av_conf);
+    int err = hts221_stat_transfer(dev, i2c_reg_read_byte_dt(&dev->i2c, HTS221_AV_CONF, av_conf));
     if (err != 0)
         return err;
 
-    err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG1, ctrl_reg1);
+    // CTRL_REG1 (0x20) to STATUS_REG (0x27) in a single auto-increment burst
+    const hts221_reg_t reg = HTS221_CTRL_REG1 | HTS221_MULTIPLE_BYTES_READ;
+    uint8_t buffer[HTS221_STATUS_REG - HTS221_CTRL_REG1 + 1];
+    err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, sizeof(buffer)));
     if (err != 0)
         return err;
 
-    err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG2, ctrl_reg2);
+    *ctrl_reg1 = buffer[HTS221_CTRL_REG1 - HTS221_CTRL_REG1];
+    *ctrl_reg2 = buffer[HTS221_CTRL_REG2 - HTS221_CTRL_REG1];
+    *ctrl_reg3 = buffer[HTS221_CTRL_REG3 - HTS221_CTRL_REG1];
+    *status_reg = buffer[HTS221_STATUS_REG - HTS221_CTRL_REG1];
+
+    return 0;
+}
+
+/*******************
+ * Data Conversion *
+ *******************/
+
+/**
+ * @brief Extracts a raw output word from its L/H register pair.
+ */
+static int16_t hts221_raw_word(const uint8_t *buffer) { return ((buffer[1] & 0b00000011) << 8) | buffer[0]; }
+
+int32_t hts221_convert_temperature_milli(const struct hts221_dev *dev, const int16_t temp_raw) {
+    return hts221_calib_temperature_milli(&dev->calibration, temp_raw);
+}
+
+int32_t hts221_convert_humidity_milli(const struct hts221_dev *dev, const int16_t humidity_raw) {
+    return hts221_calib_humidity_milli(&dev->calibration, humidity_raw);
+}
+
+int hts221_read_raw(struct hts221_dev *dev, int16_t *temp_raw, int16_t *humidity_raw) {
+    const hts221_reg_t reg = HTS221_HUMIDITY_OUT_L | HTS221_MULTIPLE_BYTES_READ;
+    uint8_t buffer[4];
+    const int err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, 4));
     if (err != 0)
         return err;
 
-    err = i2c_reg_read_byte_dt(spec, HTS221_CTRL_REG3, ctrl_reg3);
+    *temp_raw = hts221_raw_word(&buffer[2]);
+    *humidity_raw = hts221_raw_word(&buffer[0]);
+
+    return 0;
+}
+
+int hts221_read_status_raw(struct hts221_dev *dev, bool *new_humidity_available, bool *new_temp_available,
+                           int16_t *temp_raw, int16_t *humidity_raw) {
+    // STATUS_REG (0x27) is read first, so its flags refer to the data returned in the same burst
+    const hts221_reg_t reg = HTS221_STATUS_REG | HTS221_MULTIPLE_BYTES_READ;
+    uint8_t buffer[5];
+    const int err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, sizeof(buffer)));
     if (err != 0)
         return err;
 
-    err = i2c_reg_read_byte_dt(spec, HTS221_STATUS_REG, status_reg);
+    *new_humidity_available = (buffer[0] & HTS221_STATUS_REG_H_DA) >> 1;
+    *new_temp_available = buffer[0] & HTS221_STATUS_REG_T_DA;
+    *humidity_raw = hts221_raw_word(&buffer[1]);
+    *temp_raw = hts221_raw_word(&buffer[3]);
+
+    return 0;
+}
+
+static void hts221_async_complete(struct hts221_dev *dev, const int result) {
+    const hts221_raw_cb_t cb = dev->async.cb;
+    void *user_data = dev->async.user_data;
+    const int16_t temp_raw = hts221_raw_word(&dev->async.buffer[2]);
+    const int16_t humidity_raw = hts221_raw_word(&dev->async.buffer[0]);
+
+    hts221_stat_transfer(dev, result);
+    atomic_clear(&dev->async.busy);
+
+    cb(dev, result, temp_raw, humidity_raw, user_data);
+}
+
+#if CONFIG_I2C_CALLBACK
+static void hts221_async_transfer_done(const struct device *bus, int result, void *data) {
+    ARG_UNUSED(bus);
+    hts221_async_complete(data, result);
+}
+#endif
+
+static void hts221_async_work_handler(struct k_work *work) {
+    struct hts221_dev *dev = CONTAINER_OF(work, struct hts221_dev, async.work);
+    const int err = i2c_write_read_dt(&dev->i2c, &dev->async.reg, 1, dev->async.buffer, sizeof(dev->async.buffer));
+
+    hts221_async_complete(dev, err);
+}
+
+int hts221_read_raw_async(struct hts221_dev *dev, hts221_raw_cb_t cb, void *user_data) {
+    if (!atomic_cas(&dev->async.busy, 0, 1))
+        return -EBUSY;
+
+    dev->async.cb = cb;
+    dev->async.user_data = user_data;
+    dev->async.reg = HTS221_HUMIDITY_OUT_L | HTS221_MULTIPLE_BYTES_READ;
+
+#if CONFIG_I2C_CALLBACK
+    dev->async.msgs[0].buf = &dev->async.reg;
+    dev->async.msgs[0].len = 1;
+    dev->async.msgs[0].flags = I2C_MSG_WRITE;
+    dev->async.msgs[1].buf = dev->async.buffer;
+    dev->async.msgs[1].len = sizeof(dev->async.buffer);
+    dev->async.msgs[1].flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP;
+
+    const int err = i2c_transfer_cb(dev->i2c.bus, dev->async.msgs, 2, dev->i2c.addr, hts221_async_transfer_done, dev);
+    if (err != -ENOSYS) {
+        if (err != 0) {
+            hts221_stat_transfer(dev, err);
+            atomic_clear(&dev->async.busy);
+        }
+        return err;
+    }
+#endif
+
+    if (dev->async.work.handler == NULL)
+        k_work_init(&dev->async.work, hts221_async_work_handler);
+    k_work_submit(&dev->async.work);
+
+    return 0;
+}
+
+int hts221_read_all_milli(struct hts221_dev *dev, int32_t *temperature, int32_t *humidity) {
+    const hts221_reg_t reg = HTS221_HUMIDITY_OUT_L | HTS221_MULTIPLE_BYTES_READ;
+    uint8_t buffer[4];
+    const int err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, 4));
     if (err != 0)
         return err;
 
+    *temperature = hts221_convert_temperature_milli(dev, hts221_raw_word(&buffer[2]));
+    *humidity = hts221_convert_humidity_milli(dev, hts221_raw_word(&buffer[0]));
+
     return 0;
 }
 
-/*******************
- * Data Conversion *
- *******************/
+#if !CONFIG_HTS221_FIXED_POINT
+float hts221_convert_temperature(const struct hts221_dev *dev, const int16_t temp_raw) {
+    return hts221_calib_temperature(&dev->calibration, temp_raw);
+}
+
+float hts221_convert_humidity(const struct hts221_dev *dev, const int16_t humidity_raw) {
+    return hts221_calib_humidity(&dev->calibration, humidity_raw);
+}
 
-int hts221_read_temperature(const struct i2c_dt_spec *spec, float *temperature) {
+int hts221_read_temperature(struct hts221_dev *dev, float *temperature) {
     const hts221_reg_t reg = HTS221_TEMP_OUT_L | HTS221_MULTIPLE_BYTES_READ;
     uint8_t buffer[2];
-    const int err = i2c_write_read_dt(spec, &reg, 1, buffer, 2);
+    const int err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, 2));
     if (err != 0)
         return err;
 
-    const int16_t temp_x8 = ((buffer[1] & 0b00000011) << 8) | buffer[0];
-    *temperature = (float)temp_x8 * calibration_coeff.t_m + calibration_coeff.t_q;
-    *temperature /= 8.f;
+    *temperature = hts221_convert_temperature(dev, hts221_raw_word(buffer));
 
     return 0;
 }
 
-int hts221_read_humidity(const struct i2c_dt_spec *spec, float *humidity) {
+int hts221_read_humidity(struct hts221_dev *dev, float *humidity) {
     const hts221_reg_t reg = HTS221_HUMIDITY_OUT_L | HTS221_MULTIPLE_BYTES_READ;
     uint8_t buffer[2];
-    const int err = i2c_write_read_dt(spec, &reg, 1, buffer, 2);
+    const int err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, 2));
     if (err != 0)
         return err;
 
-    const int16_t humidity_x2 = ((buffer[1] & 0b00000011) << 8) | buffer[0];
-    *humidity = (float)humidity_x2 * calibration_coeff.rh_m + calibration_coeff.rh_q;
-    *humidity /= 2.f;
+    *humidity = hts221_convert_humidity(dev, hts221_raw_word(buffer));
 
     return 0;
 }
 
-int hts221_read_all(const struct i2c_dt_spec *spec, float *temperature, float *humidity) {
+int hts221_read_all(struct hts221_dev *dev, float *temperature, float *humidity) {
     const hts221_reg_t reg = HTS221_HUMIDITY_OUT_L | HTS221_MULTIPLE_BYTES_READ;
     uint8_t buffer[4];
-    const int err = i2c_write_read_dt(spec, &reg, 1, buffer, 4);
+    const int err = hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, buffer, 4));
     if (err != 0)
         return err;
 
-    const int16_t temp_x8 = ((buffer[3] & 0b00000011) << 8) | buffer[2];
-    const int16_t humidity_x2 = ((buffer[1] & 0b00000011) << 8) | buffer[0];
-
-    *temperature = (float)temp_x8 * calibration_coeff.t_m + calibration_coeff.t_q;
-    *temperature /= 8.f;
-
-    *humidity = (float)humidity_x2 * calibration_coeff.rh_m + calibration_coeff.rh_q;
-    *humidity /= 2.f;
+    *temperature = hts221_convert_temperature(dev, hts221_raw_word(&buffer[2]));
+    *humidity = hts221_convert_humidity(dev, hts221_raw_word(&buffer[0]));
 
     return 0;
 }
+#endif
 
-int hts221_read_calibration(const struct i2c_dt_spec *spec) {
+int hts221_read_calibration_raw(struct hts221_dev *dev, uint8_t raw[HTS221_CALIB_SIZE]) {
     const hts221_reg_t reg = HTS221_CALIB_0 | HTS221_MULTIPLE_BYTES_READ;
-    uint8_t buffer[16];
-    const int err = i2c_write_read_dt(spec, &reg, 1, buffer, 16);
+    return hts221_stat_transfer(dev, i2c_write_read_dt(&dev->i2c, &reg, 1, raw, HTS221_CALIB_SIZE));
+}
+
+int hts221_read_calibration(struct hts221_dev *dev) {
+    uint8_t buffer[HTS221_CALIB_SIZE];
+    const int err = hts221_read_calibration_raw(dev, buffer);
     if (err != 0)
         return err;
 
-    // Temperature
-    const uint16_t t0_degC_x8 = ((buffer[5] & 0b00000011) << 8) | buffer[2];
-    const uint16_t t1_degC_x8 = ((buffer[5] & 0b00001100) << 6) | buffer[3];
-    const int16_t t0_out = (buffer[13] << 8) | buffer[12];
-    const int16_t t1_out = (buffer[15] << 8) | buffer[14];
-
-    calibration_coeff.t_m = (float)(t1_degC_x8 - t0_degC_x8) / (float)(t1_out - t0_out);
-    calibration_coeff.t_q = (float)t1_degC_x8 - (float)t1_out * calibration_coeff.t_m;
-
-    // Humidity
-    const uint8_t h0_rh_x2 = buffer[0];
-    const uint8_t h1_rh_x2 = buffer[1];
-    const int16_t h0_t0_out = (buffer[7] << 8) | buffer[6];
-    const int16_t h1_t0_out = (buffer[9] << 8) | buffer[8];
-
-    calibration_coeff.rh_m = (float)(h1_rh_x2 - h0_rh_x2) / (float)(h1_t0_out - h0_t0_out);
-    calibration_coeff.rh_q = (float)h1_rh_x2 - (float)h1_t0_out * calibration_coeff.rh_m;
-
-    return 0;
+    return hts221_calibration_from_raw(&dev->calibration, buffer);
 }
@@ -2,9 +2,35 @@
 #define HTS221_H
 
 #include <stdint.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "hts221_convert.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #define HTS221_MULTIPLE_BYTES_READ 0b10000000
+#define HTS221_WHO_AM_I_VALUE 0xbc
+
+// Register fields
+#define HTS221_AV_CONF_AVGT 0b00111000
+#define HTS221_AV_CONF_AVGH 0b00000111
+#define HTS221_CTRL_REG1_PD 0b10000000
+#define HTS221_CTRL_REG1_BDU 0b00000100
+#define HTS221_CTRL_REG1_ODR 0b00000011
+#define HTS221_CTRL_REG2_BOOT 0b10000000
+#define HTS221_CTRL_REG2_HEATER 0b00000010
+#define HTS221_CTRL_REG2_ONE_SHOT 0b00000001
+#define HTS221_CTRL_REG3_DRDY_H_L 0b10000000
+#define HTS221_CTRL_REG3_PP_OD 0b01000000
+#define HTS221_CTRL_REG3_DRDY_EN 0b00000100
+#define HTS221_STATUS_REG_H_DA 0b00000010
+#define HTS221_STATUS_REG_T_DA 0b00000001
 
 typedef enum {
     HTS221_WHO_AM_I = 0x0f,        // r
@@ -38,150 +64,268 @@ typedef enum {
     HTS221_ODR_12_5_HZ = 0x03,   // 12.5 Hz
 } hts221_odr_config_t;
 
+struct Hts221_shadow_regs {
+    uint8_t av_conf;
+    uint8_t ctrl_reg1;
+    uint8_t ctrl_reg2;
+    uint8_t ctrl_reg3;
+    bool valid;
+};
+
+struct hts221_dev;
+
+/**
+ * @brief Completion callback of hts221_read_raw_async().
+ *
+ * @param dev HTS221 device context.
+ * @param result 0 on success, or a negative error code from the I2C transfer.
+ * @param temp_raw Raw value of the TEMP_OUT registers, valid only on success.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers, valid only on success.
+ * @param user_data Pointer passed to hts221_read_raw_async().
+ */
+typedef void (*hts221_raw_cb_t)(struct hts221_dev *dev, int result, int16_t temp_raw, int16_t humidity_raw,
+                                void *user_data);
+
+struct Hts221_async_read {
+    atomic_t busy;
+    uint8_t reg;
+    uint8_t buffer[4];
+    struct i2c_msg msgs[2];
+    struct k_work work;  // fallback when the bus does not support i2c_transfer_cb()
+    hts221_raw_cb_t cb;
+    void *user_data;
+};
+
+struct hts221_stats {
+    uint32_t transfers;  // I2C transactions issued by the driver
+    uint32_t errors;     // I2C transactions that returned an error
+};
+
+struct hts221_power {
+    bool active;           // PD bit of CTRL_REG1, as last written or read
+    int64_t active_since;  // k_uptime_get() when the sensor entered active mode
+    uint64_t active_ms;    // time spent in active mode before active_since
+};
+
+/**
+ * @brief Per-sensor driver context.
+ *
+ * @details One context is instantiated for every "st,hts221" devicetree node with status "okay". Contexts are stored in
+ * hts221_devs[], indexed by devicetree instance number.
+ */
+struct hts221_dev {
+    const struct i2c_dt_spec i2c;
+    const struct gpio_dt_spec drdy;  // port is NULL when the node has no drdy-gpios property
+    struct Hts221_calibration_coeff calibration;
+    struct Hts221_shadow_regs shadow;
+    struct hts221_stats stats;
+    struct hts221_power power;
+    struct Hts221_async_read async;
+};
+
+#define HTS221_DEV_COUNT DT_NUM_INST_STATUS_OKAY(st_hts221)
+
+extern struct hts221_dev hts221_devs[HTS221_DEV_COUNT];
+
 /**
  * @brief Reads the content of the WHO_AM_I register.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param read_buf Pointer to the variable that stores the read data.
  * @return a value from i2c_write_read_dt().
  */
-int hts221_read_whoami(const struct i2c_dt_spec *spec, uint8_t *read_buf);
+int hts221_read_whoami(struct hts221_dev *dev, uint8_t *read_buf);
 
 /************************
  * Sensor Configuration *
  ************************/
 
+/**
+ * @brief Reads AV_CONF and CTRL_REG1..3 into the driver's shadow copy of the configuration registers.
+ *
+ * @details Until this function succeeds, every setter performs a read-modify-write on the bus. Afterwards, setters
+ * compute the new value from the shadow copy and issue a single write, and getters do not access the bus at all. Call
+ * it once at startup and again after anything that changes the registers behind the driver's back (e.g. a sensor
+ * power cycle or a BOOT of the memory content).
+ *
+ * @param dev HTS221 device context.
+ * @return a value from either i2c_reg_read_byte_dt() or i2c_write_read_dt().
+ */
+int hts221_sync_shadow_regs(struct hts221_dev *dev);
+
+/**
+ * @brief Writes the shadow copy of AV_CONF and CTRL_REG1..3 back to the sensor, e.g. after a brown-out reset.
+ *
+ * @details CTRL_REG1 is written last, so that the sensor leaves power-down mode only once configured.
+ *
+ * @param dev HTS221 device context.
+ * @return -ENODATA if the shadow copy was never synced, otherwise a value from i2c_reg_write_byte_dt().
+ */
+int hts221_restore_config(struct hts221_dev *dev);
+
+/**
+ * @brief Writes a whole configuration image with two transactions: AV_CONF, then a CTRL_REG1..3 burst.
+ *
+ * @details Replaces the shadow copy, so the registers do not need to be read first. Bits outside the fields of the
+ * image are written as 0, their reset value. See hts221.hpp to build the image at compile time.
+ *
+ * @param dev HTS221 device context.
+ * @param config Register image, BOOT and ONE_SHOT must be cleared.
+ * @return a value from either i2c_reg_write_byte_dt() or i2c_write_dt().
+ */
+int hts221_write_config(struct hts221_dev *dev, const struct Hts221_shadow_regs *config);
+
 /**
  * @brief Reads the AV_CONF register and return both temperature and humidity averaged samples configurations.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param temp_conf Pointer to the variable that stores the read temperature configuration.
  * @param humidity_conf Pointer to the variable that stores the read humidity configuration.
  * @return a value from i2c_reg_read_byte_dt().
  */
-int hts221_read_av_conf(const struct i2c_dt_spec *spec, hts221_av_conf_t *temp_conf, hts221_av_conf_t *humidity_conf);
+int hts221_read_av_conf(struct hts221_dev *dev, hts221_av_conf_t *temp_conf, hts221_av_conf_t *humidity_conf);
 
 /**
  * @brief Sets the number of average sample for both temperature and humidify readings.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param temp_conf Average samples for the temperature readings.
  * @param humidity_conf Average samples for the humidity readings.
  * @return a value from i2c_reg_write_byte_dt().
  */
-int hts221_set_av_conf(const struct i2c_dt_spec *spec, const hts221_av_conf_t temp_conf,
-                       const hts221_av_conf_t humidity_conf);
+int hts221_set_av_conf(struct hts221_dev *dev, const hts221_av_conf_t temp_conf, const hts221_av_conf_t humidity_conf);
 
 /**
  * @brief Enables the sensor.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @return a value from either i2c_reg_write_byte_dt() or i2c_reg_read_byte_dt().
  */
-int hts221_enable(const struct i2c_dt_spec *spec);
+int hts221_enable(struct hts221_dev *dev);
 
 /**
  * @brief Powers off the sensor.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @return a value from either i2c_reg_write_byte_dt() or i2c_reg_read_byte_dt().
  */
-int hts221_disable(const struct i2c_dt_spec *spec);
+int hts221_disable(struct hts221_dev *dev);
 
 /**
  * @brief Sets the sensor output data rate (ODR).
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param odr_conf ODR configuration code.
  * @return a value from i2c_write_dt().
  */
-int hts221_set_odr(const struct i2c_dt_spec *spec, const hts221_odr_config_t odr_conf);
+int hts221_set_odr(struct hts221_dev *dev, const hts221_odr_config_t odr_conf);
 
 /**
  * @brief Reads the sensor output data rate.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param odr_conf ODR configuration code.
  * @return a value from i2c_reg_read_byte_dt().
  */
-int hts221_read_odr(const struct i2c_dt_spec *spec, hts221_odr_config_t *odr_conf);
+int hts221_read_odr(struct hts221_dev *dev, hts221_odr_config_t *odr_conf);
 
 /**
  * @brief Sets the sensor
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param continuous_update
  * @return int
  */
-int hts221_set_bdu(const struct i2c_dt_spec *spec, const bool continuous_update);
+int hts221_set_bdu(struct hts221_dev *dev, const bool continuous_update);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param is_continuous_update
  * @return int
  */
-int hts221_read_bdu(const struct i2c_dt_spec *spec, bool *is_continuous_update);
+int hts221_read_bdu(struct hts221_dev *dev, bool *is_continuous_update);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param enable
  * @return int
  */
-int hts221_set_heater_status(const struct i2c_dt_spec *spec, const bool enable);
+int hts221_set_heater_status(struct hts221_dev *dev, const bool enable);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param is_enabled
  * @return int
  */
-int hts221_read_heater_status(const struct i2c_dt_spec *spec, bool *is_enabled);
+int hts221_read_heater_status(struct hts221_dev *dev, bool *is_enabled);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @return int
  */
-int hts221_trigger_one_shot(const struct i2c_dt_spec *spec);
+int hts221_trigger_one_shot(struct hts221_dev *dev);
+
+/**
+ * @brief Powers on the sensor and starts a one-shot conversion with a single write to CTRL_REG1 and CTRL_REG2.
+ *
+ * @details Relies on the shadow copy of the configuration registers: without it, falls back to hts221_enable()
+ * followed by hts221_trigger_one_shot().
+ *
+ * @param dev HTS221 device context.
+ * @return a value from i2c_write_dt().
+ */
+int hts221_wake_one_shot(struct hts221_dev *dev);
+
+/**
+ * @brief Returns the time spent by the sensor in active and power-down mode since boot.
+ *
+ * @param dev HTS221 device context.
+ * @param active_ms Time with the PD bit set.
+ * @param idle_ms Time with the PD bit cleared.
+ */
+void hts221_read_power_stats(const struct hts221_dev *dev, uint64_t *active_ms, uint64_t *idle_ms);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param active_low
  * @return int
  */
-int hts221_config_data_ready(const struct i2c_dt_spec *spec, const bool active_low);
+int hts221_config_data_ready(struct hts221_dev *dev, const bool active_low);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param enable
  * @return int
  */
-int hts221_enable_data_ready(const struct i2c_dt_spec *spec, const bool enable);
+int hts221_enable_data_ready(struct hts221_dev *dev, const bool enable);
 
 /**
  * @brief
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param new_humidity_available
  * @param new_temp_available
  * @return int
  */
-int hts221_read_status(const struct i2c_dt_spec *spec, bool *new_humidity_available, bool *new_temp_available);
+int hts221_read_status(struct hts221_dev *dev, bool *new_humidity_available, bool *new_temp_available);
 
 /**
- * @brief
+ * @brief Reads the configuration and status registers with two transactions: AV_CONF, then a CTRL_REG1..STATUS_REG
+ * burst.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param av_conf
  * @param ctrl_reg1
  * @param ctrl_reg2
@@ -189,51 +333,162 @@ int hts221_read_status(const struct i2c_dt_spec *spec, bool *new_humidity_availa
  * @param status_reg
  * @return int
  */
-int hts221_read_all_conf_reg(const struct i2c_dt_spec *spec, uint8_t *av_conf, uint8_t *ctrl_reg1, uint8_t *ctrl_reg2,
+int hts221_read_all_conf_reg(struct hts221_dev *dev, uint8_t *av_conf, uint8_t *ctrl_reg1, uint8_t *ctrl_reg2,
                              uint8_t *ctrl_reg3, uint8_t *status_reg);
 
 /*******************
  * Data Conversion *
  *******************/
 
+/**
+ * @brief Reads both the temperature and humidity registers without converting them.
+ *
+ * @details Like the conversion functions, only the 10 least significant bits of each output word are kept. Use it
+ * when the conversion is deferred to a consumer, e.g. with hts221_convert_temperature_milli().
+ *
+ * @param dev HTS221 device context.
+ * @param temp_raw Raw value of the TEMP_OUT registers.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers.
+ * @return a value from i2c_write_read_dt().
+ */
+int hts221_read_raw(struct hts221_dev *dev, int16_t *temp_raw, int16_t *humidity_raw);
+
+/**
+ * @brief Reads STATUS_REG, HUMIDITY_OUT and TEMP_OUT with a single burst transaction.
+ *
+ * @details Meant for polling without DRDY: a whole I2C round trip per sample is saved compared to
+ * hts221_read_status() followed by hts221_read_raw(). The raw values are returned even when the flags are false, in
+ * which case they belong to a sample that was already read.
+ *
+ * @param dev HTS221 device context.
+ * @param new_humidity_available H_DA flag of STATUS_REG.
+ * @param new_temp_available T_DA flag of STATUS_REG.
+ * @param temp_raw Raw value of the TEMP_OUT registers.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers.
+ * @return 0 on success, otherwise the error of the I2C transfer.
+ */
+int hts221_read_status_raw(struct hts221_dev *dev, bool *new_humidity_available, bool *new_temp_available,
+                           int16_t *temp_raw, int16_t *humidity_raw);
+
+/**
+ * @brief Starts reading both the temperature and humidity registers without blocking. Can be called from an ISR.
+ *
+ * @details With CONFIG_I2C_CALLBACK the burst read is submitted with i2c_transfer_cb() and cb runs in the bus driver
+ * completion context (usually an ISR). Otherwise, or when the bus driver does not implement callbacks, the blocking
+ * read runs in the system work queue and cb is called from there. Only one asynchronous read per device can be in
+ * flight.
+ *
+ * @param dev HTS221 device context.
+ * @param cb Completion callback.
+ * @param user_data Pointer passed to cb.
+ * @return 0 if the read is started, -EBUSY if a read is already in flight, or a value from i2c_transfer_cb().
+ */
+int hts221_read_raw_async(struct hts221_dev *dev, hts221_raw_cb_t cb, void *user_data);
+
+/**
+ * @brief Converts a raw temperature word into milli-degrees Celsius using integer arithmetic only.
+ *
+ * @details The calibration slope is stored in Q16. Over the full 16-bit raw range the result stays within 1.1 milli-degC
+ * of the exact calibration line, while the single precision float conversion drifts up to 4 milli-degC at the ends.
+ *
+ * @param dev HTS221 device context.
+ * @param temp_raw Raw value of the TEMP_OUT registers.
+ * @return the temperature in milli-degrees Celsius.
+ */
+int32_t hts221_convert_temperature_milli(const struct hts221_dev *dev, const int16_t temp_raw);
+
+/**
+ * @brief Converts a raw humidity word into milli-%RH using integer arithmetic only.
+ *
+ * @details Same error bound as hts221_convert_temperature_milli(), in milli-%RH.
+ *
+ * @param dev HTS221 device context.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers.
+ * @return the relative humidity in milli-%RH.
+ */
+int32_t hts221_convert_humidity_milli(const struct hts221_dev *dev, const int16_t humidity_raw);
+
+/**
+ * @brief Reads both the temperature and humidity registers and return respective values in fixed point.
+ *
+ * @param dev HTS221 device context.
+ * @param temperature Temperature value in milli-degrees Celsius.
+ * @param humidity Humidity value in milli-%RH.
+ * @return a value from i2c_write_read_dt().
+ */
+int hts221_read_all_milli(struct hts221_dev *dev, int32_t *temperature, int32_t *humidity);
+
+#if !CONFIG_HTS221_FIXED_POINT
+/**
+ * @brief Converts a raw temperature word into degrees Celsius.
+ *
+ * @param dev HTS221 device context.
+ * @param temp_raw Raw value of the TEMP_OUT registers.
+ * @return the temperature in degrees Celsius.
+ */
+float hts221_convert_temperature(const struct hts221_dev *dev, const int16_t temp_raw);
+
+/**
+ * @brief Converts a raw humidity word into %RH.
+ *
+ * @param dev HTS221 device context.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers.
+ * @return the relative humidity in %RH.
+ */
+float hts221_convert_humidity(const struct hts221_dev *dev, const int16_t humidity_raw);
+
 /**
  * @brief Reads the temperature registers from the sensors and return a temperature value.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param temperature Temperature value converted from the 2 temperature registers (in degree Celsius).
  * @return a value from i2c_write_read_dt().
  */
-int hts221_read_temperature(const struct i2c_dt_spec *spec, float *temperature);
+int hts221_read_temperature(struct hts221_dev *dev, float *temperature);
 
 /**
  * @brief Reads the humidity registers from the sensors and return a humidity value.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
  * @param humidity Humidity value converted from the 2 humidity registers.
  * @return a value from i2c_write_read_dt().
  */
-int hts221_read_humidity(const struct i2c_dt_spec *spec, float *humidity);
+int hts221_read_humidity(struct hts221_dev *dev, float *humidity);
 
 /**
  * @brief Reads both the temperature and humidity registes and return respective values.
  *
- * @param spec I2C specification from devicetree.
- * @param humidity Humidity value converted from the 2 humidity registers.
+ * @param dev HTS221 device context.
  * @param temperature Temperature value converted from the 2 temperature registers (in degree Celsius).
+ * @param humidity Humidity value converted from the 2 humidity registers.
  * @return a value from i2c_write_read_dt().
  */
-int hts221_read_all(const struct i2c_dt_spec *spec, float *humidity, float *temperature);
+int hts221_read_all(struct hts221_dev *dev, float *temperature, float *humidity);
+#endif
 
 /**
  * @brief Read all the calibration coefficients.
  *
- * @details The user should call this function when initializing the sensor at startup. Read data is store privately and
- * not exposed to the user. The calibration coefficients are required to convert both temperature and humidity registers
- * value into floats.
+ * @details The user should call this function when initializing the sensor at startup. Read data is stored in the
+ * device context. The calibration coefficients are required to convert both temperature and humidity registers
+ * value into floats or fixed point values.
  *
- * @param spec I2C specification from devicetree.
+ * @param dev HTS221 device context.
+ * @return a value from i2c_write_read_dt(), or -EINVAL if the calibration data is not valid.
+ */
+int hts221_read_calibration(struct hts221_dev *dev);
+
+/**
+ * @brief Reads the raw calibration block (CALIB_0..CALIB_F) without computing the coefficients.
+ *
+ * @param dev HTS221 device context.
+ * @param raw Buffer that stores the calibration block.
  * @return a value from i2c_write_read_dt().
  */
-int hts221_read_calibration(const struct i2c_dt_spec *spec);
+int hts221_read_calibration_raw(struct hts221_dev *dev, uint8_t raw[HTS221_CALIB_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
@@ -0,0 +1,144 @@
+#ifndef HTS221_HPP
+#define HTS221_HPP
+
+#include <stdint.h>
+
+#include "hts221.h"
+
+/**
+ * @brief Compile-time HTS221 configuration (C++17, header only).
+ *
+ * @details The register layout and the configuration of a sensor are types: the whole configuration folds into a
+ * constant register image, written by hts221_write_config() with two transactions, and values that do not fit their
+ * field or invalid combinations fail to compile. The bus transfers, the shadow copy and the rest of the driver are the
+ * C ones of hts221.h.
+ */
+namespace hts221 {
+
+/**
+ * @brief Position of the least significant bit of a mask.
+ */
+constexpr unsigned mask_shift(const uint8_t mask) {
+    unsigned shift = 0;
+    while ((mask & (1u << shift)) == 0)
+        shift++;
+    return shift;
+}
+
+/**
+ * @brief Register field, described by its mask in hts221.h.
+ */
+template <uint8_t Mask>
+struct Field {
+    static constexpr uint8_t mask = Mask;
+    static constexpr unsigned shift = mask_shift(Mask);
+    static constexpr unsigned max = Mask >> shift;
+
+    static_assert(Mask != 0, "Empty field mask");
+    static_assert((max & (max + 1)) == 0, "Field mask bits are not contiguous");
+
+    template <unsigned Value>
+    static constexpr uint8_t encode() {
+        static_assert(Value <= max, "Value does not fit in the field");
+        return static_cast<uint8_t>(Value << shift);
+    }
+
+    static constexpr unsigned decode(const uint8_t reg) { return (reg & Mask) >> shift; }
+};
+
+/**
+ * @brief Tells whether the fields of a register do not overlap.
+ */
+template <typename... Fields>
+constexpr bool fields_disjoint() {
+    uint8_t used = 0;
+    bool disjoint = true;
+    ((disjoint = disjoint && (used & Fields::mask) == 0, used |= Fields::mask), ...);
+    return disjoint;
+}
+
+struct AvConf {
+    static constexpr hts221_reg_t address = HTS221_AV_CONF;
+    using Avgt = Field<HTS221_AV_CONF_AVGT>;
+    using Avgh = Field<HTS221_AV_CONF_AVGH>;
+    static_assert(fields_disjoint<Avgt, Avgh>(), "Overlapping AV_CONF fields");
+};
+
+struct CtrlReg1 {
+    static constexpr hts221_reg_t address = HTS221_CTRL_REG1;
+    using Pd = Field<HTS221_CTRL_REG1_PD>;
+    using Bdu = Field<HTS221_CTRL_REG1_BDU>;
+    using Odr = Field<HTS221_CTRL_REG1_ODR>;
+    static_assert(fields_disjoint<Pd, Bdu, Odr>(), "Overlapping CTRL_REG1 fields");
+};
+
+struct CtrlReg2 {
+    static constexpr hts221_reg_t address = HTS221_CTRL_REG2;
+    using Boot = Field<HTS221_CTRL_REG2_BOOT>;
+    using Heater = Field<HTS221_CTRL_REG2_HEATER>;
+    using OneShot = Field<HTS221_CTRL_REG2_ONE_SHOT>;
+    static_assert(fields_disjoint<Boot, Heater, OneShot>(), "Overlapping CTRL_REG2 fields");
+};
+
+struct CtrlReg3 {
+    static constexpr hts221_reg_t address = HTS221_CTRL_REG3;
+    using DrdyHL = Field<HTS221_CTRL_REG3_DRDY_H_L>;
+    using PpOd = Field<HTS221_CTRL_REG3_PP_OD>;
+    using DrdyEn = Field<HTS221_CTRL_REG3_DRDY_EN>;
+    static_assert(fields_disjoint<DrdyHL, PpOd, DrdyEn>(), "Overlapping CTRL_REG3 fields");
+};
+
+// The image is written with a single CTRL_REG1..3 burst
+static_assert(CtrlReg2::address == CtrlReg1::address + 1 && CtrlReg3::address == CtrlReg2::address + 1,
+              "CTRL_REG1..3 are not contiguous");
+
+/**
+ * @brief DRDY pin configuration. An open-drain output can only be active low.
+ */
+enum class Drdy : uint8_t {
+    DISABLED,
+    ACTIVE_HIGH,
+    ACTIVE_LOW,
+    ACTIVE_LOW_OPEN_DRAIN,
+};
+
+/**
+ * @brief Sensor configuration, as a type.
+ *
+ * @tparam TempAvg Average samples for the temperature readings.
+ * @tparam HumidityAvg Average samples for the humidity readings.
+ * @tparam Odr Output data rate, HTS221_ODR_ONE_SHOT for one-shot conversions.
+ * @tparam Bdu Block data update: the output registers are not updated until both L and H bytes are read.
+ * @tparam DrdyPin DRDY pin configuration.
+ * @tparam Active Active mode (PD bit), power-down otherwise.
+ * @tparam Heater Internal heater.
+ */
+template <hts221_av_conf_t TempAvg, hts221_av_conf_t HumidityAvg, hts221_odr_config_t Odr, bool Bdu, Drdy DrdyPin,
+          bool Active, bool Heater = false>
+struct Config {
+    static_assert(Odr == HTS221_ODR_ONE_SHOT || Bdu,
+                  "A continuous ODR needs BDU, otherwise a burst read may mix the bytes of two conversions");
+
+    static constexpr uint8_t av_conf = AvConf::Avgt::encode<TempAvg>() | AvConf::Avgh::encode<HumidityAvg>();
+    static constexpr uint8_t ctrl_reg1 =
+        CtrlReg1::Pd::encode<Active>() | CtrlReg1::Bdu::encode<Bdu>() | CtrlReg1::Odr::encode<Odr>();
+    static constexpr uint8_t ctrl_reg2 = CtrlReg2::Heater::encode<Heater>();  // BOOT and ONE_SHOT are commands
+    static constexpr uint8_t ctrl_reg3 =
+        CtrlReg3::DrdyHL::encode<DrdyPin == Drdy::ACTIVE_LOW || DrdyPin == Drdy::ACTIVE_LOW_OPEN_DRAIN>() |
+        CtrlReg3::PpOd::encode<DrdyPin == Drdy::ACTIVE_LOW_OPEN_DRAIN>() |
+        CtrlReg3::DrdyEn::encode<DrdyPin != Drdy::DISABLED>();
+
+    static constexpr Hts221_shadow_regs image = {av_conf, ctrl_reg1, ctrl_reg2, ctrl_reg3, true};
+
+    /**
+     * @brief Writes the register image to the sensor and replaces its shadow copy.
+     *
+     * @param dev HTS221 device context.
+     * @return a value from hts221_write_config().
+     */
+    static int apply(hts221_dev *dev) { return hts221_write_config(dev, &image); }
+};
+
+}  // namespace hts221
+
+#endif
@@ -0,0 +1,114 @@
+#include "hts221_convert.h"
+
+#include <errno.h>
+
+/*
+ * Linear conversion coefficients split for 32-bit arithmetic. With s = slope_q16 = a * 2^16 + b and the constant
+ *   c = x0_milli * 2^16 - x0_out * s + 2^15 = c_hi * 2^16 + c_lo
+ * the scalar formula (x0_milli * 2^16 + (raw - x0_out) * s + 2^15) >> 16 becomes
+ *   raw * a + c_hi + ((raw * b + c_lo) >> 16)
+ * where raw * b + c_lo is always positive and below 2^32 for raw words in 0..1023.
+ */
+struct hts221_linear_q16 {
+    int32_t a;
+    uint32_t b;
+    int32_t c_hi;
+    uint32_t c_lo;
+};
+
+static int32_t hts221_linear_milli(const int32_t x0_milli, const int16_t x0_out, const int32_t slope_q16,
+                                   const int16_t raw) {
+    const int64_t delta = (int64_t)(raw - x0_out) * slope_q16;
+    return x0_milli + (int32_t)((delta + (1 << 15)) >> 16);
+}
+
+static struct hts221_linear_q16 hts221_linear_split(const int32_t x0_milli, const int16_t x0_out,
+                                                    const int32_t slope_q16) {
+    const int64_t c = ((int64_t)x0_milli << 16) - (int64_t)x0_out * slope_q16 + (1 << 15);
+
+    return (struct hts221_linear_q16){
+        .a = slope_q16 >> 16,
+        .b = (uint32_t)slope_q16 & 0xffff,
+        .c_hi = (int32_t)(c >> 16),
+        .c_lo = (uint32_t)c & 0xffff,
+    };
+}
+
+static void hts221_linear_batch(const struct hts221_linear_q16 k, const int16_t *restrict raw, const size_t n,
+                                int32_t *restrict out) {
+    for (size_t i = 0; i < n; i++) {
+        const int32_t x = raw[i];
+        out[i] = x * k.a + k.c_hi + (int32_t)(((uint32_t)x * k.b + k.c_lo) >> 16);
+    }
+}
+
+int32_t hts221_calib_temperature_milli(const struct Hts221_calibration_coeff *calibration, const int16_t temp_raw) {
+    return hts221_linear_milli(calibration->t0_milli, calibration->t0_out, calibration->t_slope_q16, temp_raw);
+}
+
+int32_t hts221_calib_humidity_milli(const struct Hts221_calibration_coeff *calibration, const int16_t humidity_raw) {
+    return hts221_linear_milli(calibration->rh0_milli, calibration->h0_out, calibration->rh_slope_q16, humidity_raw);
+}
+
+#if !CONFIG_HTS221_FIXED_POINT
+float hts221_calib_temperature(const struct Hts221_calibration_coeff *calibration, const int16_t temp_raw) {
+    return ((float)temp_raw * calibration->t_m + calibration->t_q) / 8.f;
+}
+
+float hts221_calib_humidity(const struct Hts221_calibration_coeff *calibration, const int16_t humidity_raw) {
+    return ((float)humidity_raw * calibration->rh_m + calibration->rh_q) / 2.f;
+}
+#endif
+
+void hts221_convert_batch(const struct Hts221_calibration_coeff *calibration, const struct hts221_raw_batch *raw,
+                          const size_t n, struct hts221_milli_batch *out) {
+    // One loop per quantity: each one streams a single input and output array with loop-invariant coefficients
+    const struct hts221_linear_q16 t =
+        hts221_linear_split(calibration->t0_milli, calibration->t0_out, calibration->t_slope_q16);
+    const struct hts221_linear_q16 rh =
+        hts221_linear_split(calibration->rh0_milli, calibration->h0_out, calibration->rh_slope_q16);
+
+    hts221_linear_batch(t, raw->temp_raw, n, out->temperature);
+    hts221_linear_batch(rh, raw->humidity_raw, n, out->humidity);
+}
+
+int hts221_calibration_from_raw(struct Hts221_calibration_coeff *calibration, const uint8_t buffer[HTS221_CALIB_SIZE]) {
+    // Temperature
+    const uint16_t t0_degC_x8 = ((buffer[5] & 0b00000011) << 8) | buffer[2];
+    const uint16_t t1_degC_x8 = ((buffer[5] & 0b00001100) << 6) | buffer[3];
+    const int16_t t0_out = (buffer[13] << 8) | buffer[12];
+    const int16_t t1_out = (buffer[15] << 8) | buffer[14];
+
+    // Humidity
+    const uint8_t h0_rh_x2 = buffer[0];
+    const uint8_t h1_rh_x2 = buffer[1];
+    const int16_t h0_t0_out = (buffer[7] << 8) | buffer[6];
+    const int16_t h1_t0_out = (buffer[11] << 8) | buffer[10];
+
+    if (t1_out == t0_out || h1_t0_out == h0_t0_out)
+        return -EINVAL;
+
+    /*
+     * Fixed point: x_milli = x0_milli + (raw - x0_out) * slope_q16 / 2^16, with the slope in milli-units per LSB. The
+     * 64-bit divisions run only here, the per-sample conversion is a 32x32->64 multiply and a shift.
+     */
+    calibration->t0_out = t0_out;
+    calibration->t0_milli = t0_degC_x8 * 125;  // 1000 / 8
+    calibration->t_slope_q16 =
+        (int32_t)(((int64_t)(t1_degC_x8 - t0_degC_x8) * 125 * (1 << 16)) / (t1_out - t0_out));
+
+    calibration->h0_out = h0_t0_out;
+    calibration->rh0_milli = h0_rh_x2 * 500;  // 1000 / 2
+    calibration->rh_slope_q16 =
+        (int32_t)(((int64_t)(h1_rh_x2 - h0_rh_x2) * 500 * (1 << 16)) / (h1_t0_out - h0_t0_out));
+
+#if !CONFIG_HTS221_FIXED_POINT
+    calibration->t_m = (float)(t1_degC_x8 - t0_degC_x8) / (float)(t1_out - t0_out);
+    calibration->t_q = (float)t1_degC_x8 - (float)t1_out * calibration->t_m;
+
+    calibration->rh_m = (float)(h1_rh_x2 - h0_rh_x2) / (float)(h1_t0_out - h0_t0_out);
+    calibration->rh_q = (float)h1_rh_x2 - (float)h1_t0_out * calibration->rh_m;
+#endif
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef HTS221_CONVERT_H
+#define HTS221_CONVERT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTS221_CALIB_SIZE 16  // CALIB_0..CALIB_F
+
+struct Hts221_calibration_coeff {
+#if !CONFIG_HTS221_FIXED_POINT
+    // Temperature
+    float t_m;
+    float t_q;
+
+    // Humidity
+    float rh_m;
+    float rh_q;
+#endif
+
+    // Temperature, fixed point (milli-degC)
+    int32_t t0_milli;
+    int32_t t_slope_q16;
+    int16_t t0_out;
+
+    // Humidity, fixed point (milli-%RH)
+    int32_t rh0_milli;
+    int32_t rh_slope_q16;
+    int16_t h0_out;
+};
+
+/**
+ * @brief Raw samples in structure-of-arrays layout, as returned by hts221_read_raw() (10 bit, 0..1023).
+ */
+struct hts221_raw_batch {
+    const int16_t *temp_raw;
+    const int16_t *humidity_raw;
+};
+
+/**
+ * @brief Converted samples in structure-of-arrays layout.
+ */
+struct hts221_milli_batch {
+    int32_t *temperature;  // milli-degC
+    int32_t *humidity;     // milli-%RH
+};
+
+/**
+ * @brief Computes the calibration coefficients from a raw calibration block.
+ *
+ * @param calibration Coefficients to compute.
+ * @param raw Calibration block, as read by hts221_read_calibration_raw().
+ * @return 0 on success, -EINVAL if the calibration data is not valid.
+ */
+int hts221_calibration_from_raw(struct Hts221_calibration_coeff *calibration, const uint8_t raw[HTS221_CALIB_SIZE]);
+
+/**
+ * @brief Converts a raw temperature word into milli-degrees Celsius, one sample at a time.
+ *
+ * @param calibration Calibration coefficients of the sensor.
+ * @param temp_raw Raw value of the TEMP_OUT registers.
+ * @return int32_t Temperature in milli-degC.
+ */
+int32_t hts221_calib_temperature_milli(const struct Hts221_calibration_coeff *calibration, const int16_t temp_raw);
+
+/**
+ * @brief Converts a raw humidity word into milli-%RH, one sample at a time.
+ *
+ * @param calibration Calibration coefficients of the sensor.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers.
+ * @return int32_t Relative humidity in milli-%RH.
+ */
+int32_t hts221_calib_humidity_milli(const struct Hts221_calibration_coeff *calibration, const int16_t humidity_raw);
+
+#if !CONFIG_HTS221_FIXED_POINT
+/**
+ * @brief Converts a raw temperature word into degrees Celsius, in single precision.
+ *
+ * @param calibration Calibration coefficients of the sensor.
+ * @param temp_raw Raw value of the TEMP_OUT registers.
+ * @return the temperature in degrees Celsius.
+ */
+float hts221_calib_temperature(const struct Hts221_calibration_coeff *calibration, const int16_t temp_raw);
+
+/**
+ * @brief Converts a raw humidity word into %RH, in single precision.
+ *
+ * @param calibration Calibration coefficients of the sensor.
+ * @param humidity_raw Raw value of the HUMIDITY_OUT registers.
+ * @return the relative humidity in %RH.
+ */
+float hts221_calib_humidity(const struct Hts221_calibration_coeff *calibration, const int16_t humidity_raw);
+#endif
+
+/**
+ * @brief Converts n raw samples of the same sensor into milli-units.
+ *
+ * @details Gives the same results as the scalar functions for raw words in 0..1023, but only uses 32-bit arithmetic in
+ * the inner loops so that the compiler can vectorise them. The output arrays must not overlap the input ones.
+ *
+ * @param calibration Calibration coefficients of the sensor.
+ * @param raw Raw samples.
+ * @param n Number of samples.
+ * @param out Converted samples.
+ */
+void hts221_convert_batch(const struct Hts221_calibration_coeff *calibration, const struct hts221_raw_batch *raw,
+                          const size_t n, struct hts221_milli_batch *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,146 @@
+#include "hts221_recovery.h"
+
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include "config_log.h"
+#include "hts221/hts221.h"
+
+struct hts221_recovery {
+    struct k_work_delayable work;
+    uint32_t backoff_ms;        // delay before the next attempt
+    uint32_t attempts;          // attempts of the recovery in progress
+    int64_t started_ms;         // uptime of the request of the recovery in progress
+    atomic_t samples;           // samples published
+    atomic_t requests;          // recoveries requested
+    uint32_t watchdog_samples;  // samples at the previous watchdog check
+    uint32_t total_attempts;
+    uint32_t recoveries;
+};
+
+static struct hts221_recovery hts221_recovery[HTS221_DEV_COUNT];
+static atomic_t hts221_recovery_mask;  // bit n set while hts221_devs[n] is being recovered
+static uint32_t hts221_watchdog_ms;
+
+/**
+ * @brief Probes the sensor, clears the bus if the probe fails, restores the configuration and re-arms DRDY.
+ */
+static int hts221_recovery_attempt(struct hts221_dev *hts221) {
+    uint8_t who_am_i = 0;
+
+    int err = hts221_read_whoami(hts221, &who_am_i);
+    if (err != 0 || who_am_i != HTS221_WHO_AM_I_VALUE) {
+        // A device reset in the middle of a byte can hold SDA low: clock it out
+        err = i2c_recover_bus(hts221->i2c.bus);
+        if (err != 0 && err != -ENOSYS)
+            return err;
+
+        err = hts221_read_whoami(hts221, &who_am_i);
+        if (err != 0)
+            return err;
+        if (who_am_i != HTS221_WHO_AM_I_VALUE)
+            return -ENODEV;
+    }
+
+    // A brown-out resets the configuration registers, the shadow copy holds the configuration set at boot
+    err = hts221_restore_config(hts221);
+    if (err != 0)
+        return err;
+
+    // DRDY stays active, without any new edge, until the output registers are read
+    int16_t temp_raw, humidity_raw;
+    return hts221_read_raw(hts221, &temp_raw, &humidity_raw);
+}
+
+static void hts221_recovery_handler(struct k_work *work) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct hts221_recovery *recovery = CONTAINER_OF(dwork, struct hts221_recovery, work);
+    const size_t sensor = recovery - hts221_recovery;
+    struct hts221_dev *hts221 = &hts221_devs[sensor];
+
+    recovery->attempts++;
+    recovery->total_attempts++;
+    pm_device_runtime_get(hts221->i2c.bus);
+    const int err = hts221_recovery_attempt(hts221);
+    pm_device_runtime_put(hts221->i2c.bus);
+
+    if (err != 0) {
+        LOG_WRN("Error %d: HTS221 (I2C@%x) recovery attempt %u failed, next one in %u ms.", err, hts221->i2c.addr,
+                recovery->attempts, recovery->backoff_ms);
+        k_work_schedule(dwork, K_MSEC(recovery->backoff_ms));
+        recovery->backoff_ms = MIN(2 * recovery->backoff_ms, CONFIG_HTS221_RECOVERY_MAX_BACKOFF_MS);
+        return;
+    }
+
+    recovery->recoveries++;
+    LOG_INF("HTS221 (I2C@%x) recovered in %u ms, %u attempts (%u recoveries, %u requests).", hts221->i2c.addr,
+            (uint32_t)(k_uptime_get() - recovery->started_ms), recovery->attempts, recovery->recoveries,
+            (uint32_t)atomic_get(&recovery->requests));
+    recovery->watchdog_samples = atomic_get(&recovery->samples);
+    atomic_clear_bit(&hts221_recovery_mask, sensor);
+}
+
+static void hts221_watchdog_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(hts221_watchdog_work, hts221_watchdog_handler);
+
+/**
+ * @brief Recovers the sensors that published no sample since the previous check, e.g. because DRDY is stuck active.
+ */
+static void hts221_watchdog_handler(struct k_work *work) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        struct hts221_recovery *recovery = &hts221_recovery[i];
+        const uint32_t samples = atomic_get(&recovery->samples);
+
+        if (samples == recovery->watchdog_samples && !hts221_recovery_pending(i)) {
+            LOG_WRN("HTS221 (I2C@%x) no sample for %u ms.", hts221_devs[i].i2c.addr, hts221_watchdog_ms);
+            hts221_recovery_request(i);
+        }
+        recovery->watchdog_samples = samples;
+    }
+
+    k_work_schedule(&hts221_watchdog_work, K_MSEC(hts221_watchdog_ms));
+}
+
+void hts221_recovery_init(void) {
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++)
+        k_work_init_delayable(&hts221_recovery[i].work, hts221_recovery_handler);
+}
+
+void hts221_recovery_start_watchdog(const uint32_t watchdog_ms) {
+    hts221_watchdog_ms = watchdog_ms;
+    k_work_schedule(&hts221_watchdog_work, K_MSEC(watchdog_ms));
+}
+
+void hts221_recovery_request(const size_t sensor) {
+    struct hts221_recovery *recovery = &hts221_recovery[sensor];
+
+    if (atomic_test_and_set_bit(&hts221_recovery_mask, sensor))
+        return;
+
+    atomic_inc(&recovery->requests);
+    recovery->attempts = 0;
+    recovery->started_ms = k_uptime_get();
+    recovery->backoff_ms = MIN(2 * CONFIG_HTS221_RECOVERY_MIN_BACKOFF_MS, CONFIG_HTS221_RECOVERY_MAX_BACKOFF_MS);
+    k_work_schedule(&recovery->work, K_MSEC(CONFIG_HTS221_RECOVERY_MIN_BACKOFF_MS));
+}
+
+bool hts221_recovery_pending(const size_t sensor) { return atomic_test_bit(&hts221_recovery_mask, sensor); }
+
+void hts221_recovery_sample(const size_t sensor) { atomic_inc(&hts221_recovery[sensor].samples); }
+
+void hts221_recovery_get_stats(const size_t sensor, struct hts221_recovery_stats *stats) {
+    const struct hts221_recovery *recovery = &hts221_recovery[sensor];
+
+    stats->samples = atomic_get(&recovery->samples);
+    stats->requests = atomic_get(&recovery->requests);
+    stats->attempts = recovery->total_attempts;
+    stats->recoveries = recovery->recoveries;
+}
@@ -0,0 +1,56 @@
+#ifndef HTS221_RECOVERY_H
+#define HTS221_RECOVERY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Recovery counters of one sensor.
+ */
+struct hts221_recovery_stats {
+    uint32_t samples;     // samples published
+    uint32_t requests;    // recoveries requested after an error, a timeout or a watchdog expiry
+    uint32_t attempts;    // recovery attempts, including the failed ones
+    uint32_t recoveries;  // successful recoveries
+};
+
+/**
+ * @brief Initializes the recovery of every sensor, before the first request.
+ */
+void hts221_recovery_init(void);
+
+/**
+ * @brief Starts the acquisition watchdog, once the sensors are configured.
+ *
+ * @param watchdog_ms A sensor that publishes no sample for this long is recovered.
+ */
+void hts221_recovery_start_watchdog(const uint32_t watchdog_ms);
+
+/**
+ * @brief Requests the recovery of a sensor after a bus error or a missing conversion.
+ *
+ * @details May run in ISR context. The recovery runs on the system work queue: WHO_AM_I probe, I2C bus clear when the
+ * probe fails, configuration restored from the shadow registers and DRDY re-armed by reading the output registers.
+ * Failed attempts are retried with an exponential backoff. Requests for a sensor already in recovery are merged.
+ *
+ * @param sensor Index in hts221_devs[].
+ */
+void hts221_recovery_request(const size_t sensor);
+
+/**
+ * @brief Tells whether a sensor is being recovered: the acquisition must not access it meanwhile.
+ */
+bool hts221_recovery_pending(const size_t sensor);
+
+/**
+ * @brief Counts a sample published by a sensor, for the watchdog. May run in ISR context.
+ */
+void hts221_recovery_sample(const size_t sensor);
+
+/**
+ * @brief Copies the recovery counters of a sensor.
+ */
+void hts221_recovery_get_stats(const size_t sensor, struct hts221_recovery_stats *stats);
+
+#endif
@@ -0,0 +1,17 @@
+#include "hts221_static_config.h"
+
+#include "hts221/hts221.hpp"
+#include "thread_hts221.h"
+
+namespace {
+
+using AppConfig = hts221::Config<HTS221_AVG_CONFIG_2, HTS221_AVG_CONFIG_2, HTS221_ACQ_ODR, true,
+                                 hts221::Drdy::ACTIVE_HIGH, !IS_ENABLED(CONFIG_HTS221_POWER_DOWN)>;
+
+// AVGT = 8, AVGH = 16, BDU and DRDY enabled: only PD and ODR depend on the Kconfig options
+static_assert(AppConfig::av_conf == 0x12 && AppConfig::ctrl_reg2 == 0x00 && AppConfig::ctrl_reg3 == 0x04,
+              "Unexpected HTS221 register image");
+
+}  // namespace
+
+int hts221_static_config_apply(struct hts221_dev *dev) { return AppConfig::apply(dev); }
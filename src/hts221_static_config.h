@@ -0,0 +1,24 @@
+#ifndef HTS221_STATIC_CONFIG_H
+#define HTS221_STATIC_CONFIG_H
+
+#include "hts221/hts221.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Writes the application configuration of the sensor, computed at compile time, with two transactions.
+ *
+ * @details Same configuration as the register by register sequence of config_hts221(), including the power mode.
+ *
+ * @param dev HTS221 device context.
+ * @return a value from hts221_write_config().
+ */
+int hts221_static_config_apply(struct hts221_dev *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+#include "hts221_stats.h"
+
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/util.h>
+
+#include "hts221/hts221.h"
+
+#if CONFIG_SAMPLE_BATCH
+#define HTS221_STATS_HANDOFF_MAX_US (CONFIG_SAMPLE_BATCH_MAX_LATENCY_MS * 1000)
+#else
+#define HTS221_STATS_HANDOFF_MAX_US (CONFIG_SAMPLE_LOG_PERIOD_MS * 1000)
+#endif
+
+// Bucket widths, in microseconds
+static const uint32_t hts221_stats_bucket_us[HTS221_STAT_COUNT] = {
+    [HTS221_STAT_ISR] = 1,
+    [HTS221_STAT_DISPATCH] = 20,
+    [HTS221_STAT_I2C] = 50,
+    [HTS221_STAT_LATENCY] = 100,
+    [HTS221_STAT_HANDOFF] = DIV_ROUND_UP(HTS221_STATS_HANDOFF_MAX_US, TIMING_HIST_BUCKETS - 1),
+    [HTS221_STAT_CONVERT] = 5,
+};
+
+static const char *const hts221_stats_names[HTS221_STAT_COUNT] = {
+    [HTS221_STAT_ISR] = "isr",
+    [HTS221_STAT_DISPATCH] = "dispatch",
+    [HTS221_STAT_I2C] = "i2c",
+    [HTS221_STAT_LATENCY] = "latency",
+    [HTS221_STAT_HANDOFF] = "handoff",
+    [HTS221_STAT_CONVERT] = "convert",
+};
+
+static struct timing_hist hts221_stats_hist[HTS221_STAT_COUNT];
+static struct k_spinlock hts221_stats_lock;
+
+// Cycle counter at the last event of the sample in flight of every sensor
+static uint32_t hts221_stats_drdy_cyc[HTS221_DEV_COUNT];
+static uint32_t hts221_stats_i2c_cyc[HTS221_DEV_COUNT];
+static atomic_t hts221_stats_drdy_valid;  // bitmask: hts221_stats_drdy_cyc[] belongs to the sample in flight
+static uint32_t hts221_stats_published_cyc;
+#if CONFIG_TIMING_FUNCTIONS
+static uint32_t hts221_stats_cyc_per_us;
+#endif
+
+static uint32_t hts221_stats_to_us(const uint32_t cycles) {
+#if CONFIG_TIMING_FUNCTIONS
+    return cycles / hts221_stats_cyc_per_us;
+#else
+    return k_cyc_to_us_floor32(cycles);
+#endif
+}
+
+static void hts221_stats_add(const enum hts221_stat stat, const uint32_t start) {
+    const uint32_t value_us = hts221_stats_to_us(hts221_stats_now() - start);
+    k_spinlock_key_t key = k_spin_lock(&hts221_stats_lock);
+
+    timing_hist_add(&hts221_stats_hist[stat], value_us);
+
+    k_spin_unlock(&hts221_stats_lock, key);
+}
+
+void hts221_stats_init(void) {
+#if CONFIG_TIMING_FUNCTIONS
+    timing_init();
+    timing_start();
+    hts221_stats_cyc_per_us = MAX(timing_freq_get_mhz(), 1);
+#endif
+    hts221_stats_reset();
+}
+
+void hts221_stats_reset(void) {
+    k_spinlock_key_t key = k_spin_lock(&hts221_stats_lock);
+
+    for (size_t i = 0; i < HTS221_STAT_COUNT; i++)
+        timing_hist_init(&hts221_stats_hist[i], hts221_stats_bucket_us[i]);
+
+    k_spin_unlock(&hts221_stats_lock, key);
+}
+
+void hts221_stats_get(const enum hts221_stat stat, struct timing_hist *hist) {
+    k_spinlock_key_t key = k_spin_lock(&hts221_stats_lock);
+
+    *hist = hts221_stats_hist[stat];
+
+    k_spin_unlock(&hts221_stats_lock, key);
+}
+
+const char *hts221_stats_name(const enum hts221_stat stat) { return hts221_stats_names[stat]; }
+
+void hts221_stats_drdy(const size_t sensor, const uint32_t start) {
+    hts221_stats_drdy_cyc[sensor] = start;
+    atomic_set_bit(&hts221_stats_drdy_valid, sensor);
+}
+
+void hts221_stats_isr_exit(const uint32_t start) { hts221_stats_add(HTS221_STAT_ISR, start); }
+
+void hts221_stats_i2c_start(const size_t sensor) {
+    if (atomic_test_bit(&hts221_stats_drdy_valid, sensor))
+        hts221_stats_add(HTS221_STAT_DISPATCH, hts221_stats_drdy_cyc[sensor]);
+    hts221_stats_i2c_cyc[sensor] = hts221_stats_now();
+}
+
+void hts221_stats_i2c_done(const size_t sensor) { hts221_stats_add(HTS221_STAT_I2C, hts221_stats_i2c_cyc[sensor]); }
+
+void hts221_stats_published(const size_t sensor) {
+    // Samples read by polling after a missed DRDY edge have no ISR entry
+    if (atomic_test_and_clear_bit(&hts221_stats_drdy_valid, sensor))
+        hts221_stats_add(HTS221_STAT_LATENCY, hts221_stats_drdy_cyc[sensor]);
+    hts221_stats_published_cyc = hts221_stats_now();
+}
+
+void hts221_stats_consumed(void) { hts221_stats_add(HTS221_STAT_HANDOFF, hts221_stats_published_cyc); }
+
+void hts221_stats_converted(const uint32_t start) { hts221_stats_add(HTS221_STAT_CONVERT, start); }
+
+#if CONFIG_SHELL
+static int cmd_hts221_stats(const struct shell *sh, size_t argc, char **argv) {
+    struct timing_hist hist;
+
+    shell_print(sh, "%-10s %8s %8s %8s %8s %8s (us)", "stage", "n", "min", "mean", "p99", "max");
+    for (size_t i = 0; i < HTS221_STAT_COUNT; i++) {
+        hts221_stats_get(i, &hist);
+        if (hist.count == 0) {
+            shell_print(sh, "%-10s %8u", hts221_stats_name(i), 0);
+            continue;
+        }
+        shell_print(sh, "%-10s %8u %8u %8u %8u %8u", hts221_stats_name(i), hist.count, hist.min_us,
+                    (uint32_t)(hist.sum_us / hist.count), timing_hist_percentile(&hist, 99), hist.max_us);
+    }
+
+    return 0;
+}
+
+static int cmd_hts221_stats_reset(const struct shell *sh, size_t argc, char **argv) {
+    hts221_stats_reset();
+    shell_print(sh, "HTS221 statistics cleared.");
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_hts221_stats,
+                               SHELL_CMD(reset, NULL, "Clear the hot path statistics.", cmd_hts221_stats_reset),
+                               SHELL_SUBCMD_SET_END);
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_hts221,
+                               SHELL_CMD(stats, &sub_hts221_stats, "Print the hot path statistics.", cmd_hts221_stats),
+                               SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(hts221, &sub_hts221, "HTS221 commands", NULL);
+#endif
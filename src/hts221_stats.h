@@ -0,0 +1,117 @@
+#ifndef HTS221_STATS_H
+#define HTS221_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#if CONFIG_TIMING_FUNCTIONS
+#include <zephyr/timing/timing.h>
+#endif
+
+#include "timing_hist.h"
+
+/*
+ * Hot path instrumentation of the HTS221 acquisition, from the DRDY edge to the sample consumer.
+ *
+ * Every event reads a free running cycle counter (the timing functions, i.e. the DWT cycle counter on Cortex-M, when
+ * available, k_cycle_get_32() otherwise) and adds the time since the previous event of the same sample to a histogram.
+ * The histograms are read with the `hts221 stats` shell command. Without CONFIG_HTS221_STATS every event is an empty
+ * inline function.
+ */
+
+enum hts221_stat {
+    HTS221_STAT_ISR,       // DRDY ISR entry to exit
+    HTS221_STAT_DISPATCH,  // DRDY ISR entry to I2C read start
+    HTS221_STAT_I2C,       // I2C read start to data available
+    HTS221_STAT_LATENCY,   // DRDY ISR entry to sample published
+    HTS221_STAT_HANDOFF,   // newest sample published to sample consumer running
+    HTS221_STAT_CONVERT,   // raw to physical conversion of a batch of samples
+    HTS221_STAT_COUNT,
+};
+
+#if CONFIG_HTS221_STATS
+static inline uint32_t hts221_stats_now(void) {
+#if CONFIG_TIMING_FUNCTIONS
+    return (uint32_t)timing_counter_get();
+#else
+    return k_cycle_get_32();
+#endif
+}
+
+/**
+ * @brief Starts the cycle counter and clears the histograms.
+ */
+void hts221_stats_init(void);
+
+/**
+ * @brief Clears the histograms.
+ */
+void hts221_stats_reset(void);
+
+/**
+ * @brief Copies the histogram of one stage.
+ *
+ * @param stat Stage to read.
+ * @param hist Pointer to the histogram that stores the copy, values in microseconds.
+ */
+void hts221_stats_get(const enum hts221_stat stat, struct timing_hist *hist);
+
+/**
+ * @brief Name of a stage, as printed by the shell command.
+ */
+const char *hts221_stats_name(const enum hts221_stat stat);
+
+/**
+ * @brief DRDY edge of a sensor, handled by the DRDY ISR.
+ *
+ * @param sensor Index in hts221_devs[].
+ * @param start Value of hts221_stats_now() at the ISR entry.
+ */
+void hts221_stats_drdy(const size_t sensor, const uint32_t start);
+
+/**
+ * @brief DRDY ISR exit.
+ *
+ * @param start Value of hts221_stats_now() at the ISR entry.
+ */
+void hts221_stats_isr_exit(const uint32_t start);
+
+/**
+ * @brief Start of the I2C read of a sensor that raised DRDY.
+ */
+void hts221_stats_i2c_start(const size_t sensor);
+
+/**
+ * @brief End of the I2C read started with hts221_stats_i2c_start().
+ */
+void hts221_stats_i2c_done(const size_t sensor);
+
+/**
+ * @brief Sample of a sensor published to the sample channel.
+ */
+void hts221_stats_published(const size_t sensor);
+
+/**
+ * @brief Sample consumer woken up with buffered samples.
+ */
+void hts221_stats_consumed(void);
+
+/**
+ * @brief End of the conversion of a batch of samples.
+ *
+ * @param start Value of hts221_stats_now() before the conversion.
+ */
+void hts221_stats_converted(const uint32_t start);
+#else
+static inline uint32_t hts221_stats_now(void) { return 0; }
+static inline void hts221_stats_init(void) {}
+static inline void hts221_stats_drdy(const size_t sensor, const uint32_t start) {}
+static inline void hts221_stats_isr_exit(const uint32_t start) {}
+static inline void hts221_stats_i2c_start(const size_t sensor) {}
+static inline void hts221_stats_i2c_done(const size_t sensor) {}
+static inline void hts221_stats_published(const size_t sensor) {}
+static inline void hts221_stats_consumed(void) {}
+static inline void hts221_stats_converted(const uint32_t start) {}
+#endif
+
+#endif
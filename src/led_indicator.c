@@ -0,0 +1,169 @@
+#include "led_indicator.h"
+
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+
+#include "channels.h"
+
+// Boards with an RGB LED name its channels with the led-red, led-green and led-blue aliases (see the Thingy:52
+// overlay), otherwise led0 shows every color
+#define LED_RGB \
+    (DT_NODE_EXISTS(DT_ALIAS(led_red)) && DT_NODE_EXISTS(DT_ALIAS(led_green)) && DT_NODE_EXISTS(DT_ALIAS(led_blue)))
+#if CONFIG_BOARD_THINGY52_NRF52832
+BUILD_ASSERT(LED_RGB, "The Thingy:52 overlay must define the led-red, led-green and led-blue aliases");
+#endif
+
+#if LED_RGB
+#define LED_CHANNEL_COUNT 3
+#define LED_FIRST_NODE DT_ALIAS(led_red)
+#else
+#define LED_CHANNEL_COUNT 1
+#define LED_FIRST_NODE DT_ALIAS(led0)
+#endif
+
+// LEDs behind an I2C GPIO expander (SX1509B on the Thingy:52) cannot be driven from the timer ISR
+#define LED_ON_I2C DT_ON_BUS(DT_GPIO_CTLR(LED_FIRST_NODE, gpios), i2c)
+
+#define LED_RED BIT(0)
+#define LED_GREEN BIT(1)
+#define LED_BLUE BIT(2)
+
+/**
+ * @brief Blink code: the LED blinks `blinks` times in `color`, then stays off for `gap_ms`.
+ */
+struct led_pattern {
+    uint8_t color;
+    uint8_t blinks;
+    uint16_t on_ms;
+    uint16_t off_ms;
+    uint16_t gap_ms;
+};
+
+static const struct led_pattern led_patterns[] = {
+    [STATUS_SAMPLE_OK] = {.color = LED_GREEN, .blinks = 1, .on_ms = 100, .off_ms = 100, .gap_ms = 0},
+    [STATUS_I2C_ERROR] = {.color = LED_RED, .blinks = 2, .on_ms = 150, .off_ms = 150, .gap_ms = 500},
+    [STATUS_TIMEOUT] = {.color = LED_RED | LED_GREEN, .blinks = 3, .on_ms = 150, .off_ms = 150, .gap_ms = 500},
+    [STATUS_OVERFLOW] = {.color = LED_BLUE, .blinks = 4, .on_ms = 150, .off_ms = 150, .gap_ms = 500},
+};
+
+// Indexed by the bit of the color
+static const struct gpio_dt_spec led_channels[LED_CHANNEL_COUNT] = {
+#if LED_RGB
+    GPIO_DT_SPEC_GET(DT_ALIAS(led_red), gpios),
+    GPIO_DT_SPEC_GET(DT_ALIAS(led_green), gpios),
+    GPIO_DT_SPEC_GET(DT_ALIAS(led_blue), gpios),
+#else
+    GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios),
+#endif
+};
+
+static atomic_t led_color;
+static atomic_t led_busy = ATOMIC_INIT(1);  // set while a pattern is shown, and until the LEDs are configured
+static const struct led_pattern *led_pattern;
+static uint8_t led_step;  // even steps turn the LED on, odd steps turn it off
+
+static void led_apply(void) {
+    const atomic_val_t color = atomic_get(&led_color);
+
+    if (LED_CHANNEL_COUNT == 1) {
+        gpio_pin_set_dt(&led_channels[0], color != 0);
+        return;
+    }
+    for (size_t i = 0; i < LED_CHANNEL_COUNT; i++)
+        gpio_pin_set_dt(&led_channels[i], (color & BIT(i)) != 0);
+}
+
+#if LED_ON_I2C
+static void led_work_handler(struct k_work *work) { led_apply(); }
+
+static K_WORK_DEFINE(led_work, led_work_handler);
+#endif
+
+static void led_set(const uint8_t color) {
+    atomic_set(&led_color, color);
+#if LED_ON_I2C
+    k_work_submit(&led_work);
+#else
+    led_apply();
+#endif
+}
+
+/**
+ * @brief Pops the next pattern to show: queued successful samples are shown by a single blink, errors are never
+ * skipped.
+ *
+ * @return Next pattern, NULL when the queue is empty.
+ */
+static const struct led_pattern *led_next_pattern(void) {
+    const struct led_pattern *pattern = NULL;
+    struct status_msg status;
+
+    while (k_msgq_get(&led_status_msgq, &status, K_NO_WAIT) == 0) {
+        if (status.status >= ARRAY_SIZE(led_patterns))
+            continue;
+        pattern = &led_patterns[status.status];
+        if (status.status != STATUS_SAMPLE_OK)
+            break;
+    }
+
+    return pattern;
+}
+
+static void led_timer_expired(struct k_timer *timer) {
+    if (led_pattern == NULL || led_step >= 2 * led_pattern->blinks) {
+        led_pattern = led_next_pattern();
+        led_step = 0;
+        if (led_pattern == NULL) {
+            atomic_clear(&led_busy);
+            // A status published after led_next_pattern() found the queue empty did not restart the timer
+            if (k_msgq_num_used_get(&led_status_msgq) > 0)
+                led_indicator_notify();
+            return;
+        }
+    }
+
+    const bool on = (led_step % 2) == 0;
+    uint32_t duration_ms = on ? led_pattern->on_ms : led_pattern->off_ms;
+    if (led_step == 2 * led_pattern->blinks - 1)
+        duration_ms += led_pattern->gap_ms;
+
+    led_set(on ? led_pattern->color : 0);
+    led_step++;
+    k_timer_start(timer, K_MSEC(duration_ms), K_NO_WAIT);
+}
+
+static K_TIMER_DEFINE(led_timer, led_timer_expired, NULL);
+
+void led_indicator_notify(void) {
+    if (atomic_cas(&led_busy, 0, 1))
+        k_timer_start(&led_timer, K_NO_WAIT, K_NO_WAIT);
+}
+
+static int led_indicator_init(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    int err;
+
+    for (size_t i = 0; i < LED_CHANNEL_COUNT; i++) {
+        if (!device_is_ready(led_channels[i].port)) {
+            LOG_ERR("LED port %s not ready.", led_channels[i].port->name);
+            return 1;
+        }
+
+        err = gpio_pin_configure_dt(&led_channels[i], GPIO_OUTPUT_INACTIVE);
+        if (err < 0) {
+            LOG_ERR("Error during LED %zu configuration.", i);
+            return 1;
+        }
+    }
+
+    // Show the statuses published before the LEDs were configured
+    atomic_clear(&led_busy);
+    led_indicator_notify();
+
+    return 0;
+}
+
+SYS_INIT(led_indicator_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
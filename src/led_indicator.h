@@ -0,0 +1,14 @@
+#ifndef LED_INDICATOR_H
+#define LED_INDICATOR_H
+
+#include "config_log.h"
+
+/**
+ * @brief Starts showing the statuses queued in led_status_msgq, unless a pattern is already being shown.
+ *
+ * @details Called by the status channel after every publish, may run in ISR context. The blink patterns are driven by
+ * a k_timer, so the indicator needs no thread.
+ */
+void led_indicator_notify(void);
+
+#endif
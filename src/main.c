@@ -4,20 +4,23 @@
 #include <zephyr/logging/log.h>
 
 #include "config_log.h"
-#include "events.h"
+#include "thread_bench.h"
 #include "thread_hts221.h"
-#include "thread_led.h"
+#include "thread_sample_log.h"
 
 LOG_MODULE_REGISTER(pcs_weather, LOG_LEVEL);
 
-#define BLINK_THREAD_STACKSIZE 1024
-#define HTS221_THREAD_STACKSIZE 1024
-#define BLINK_THREAD_PRIORITY 4
 #define HTS221_THREAD_PRIORITY 4
+#define SAMPLE_LOG_THREAD_PRIORITY 6
+#define BENCH_THREAD_PRIORITY 5
 
-K_EVENT_DEFINE(events);
+K_THREAD_DEFINE(hts221_thread_id, CONFIG_HTS221_THREAD_STACK_SIZE, hts221_thread, NULL, NULL, NULL,
+                HTS221_THREAD_PRIORITY, 0, 0);
 
-K_THREAD_DEFINE(blink_thread_id, BLINK_THREAD_STACKSIZE, blink_thread, NULL, NULL, NULL, BLINK_THREAD_PRIORITY, 0, 0);
+K_THREAD_DEFINE(sample_log_thread_id, CONFIG_SAMPLE_LOG_THREAD_STACK_SIZE, sample_log_thread, NULL, NULL, NULL,
+                SAMPLE_LOG_THREAD_PRIORITY, 0, 0);
 
-K_THREAD_DEFINE(hts221_thread_id, HTS221_THREAD_STACKSIZE, hts221_thread, NULL, NULL, NULL, HTS221_THREAD_PRIORITY, 0,
-                0);
+#if CONFIG_BOARD_NATIVE_SIM
+K_THREAD_DEFINE(bench_thread_id, CONFIG_BENCH_THREAD_STACK_SIZE, bench_thread, NULL, NULL, NULL, BENCH_THREAD_PRIORITY,
+                0, 0);
+#endif
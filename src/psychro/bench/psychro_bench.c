@@ -0,0 +1,120 @@
+/*
+ * Host accuracy check and microbenchmark of the dew point and absolute humidity of src/psychro, against the Magnus
+ * formula in double precision. `make bench_psychro` builds and runs it outside Zephyr twice: with the logf()/expf()
+ * path and with CONFIG_PSYCHRO_TABLES.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "psychro.h"
+
+#define BENCH_SAMPLES 4096
+#define BENCH_ROUNDS 2000
+#define BENCH_MAX_DEW_POINT_ERROR_MILLI 20  // milli-degC
+#define BENCH_MAX_ABS_HUMIDITY_ERROR 2e-3   // relative, plus 1 mg/m^3 of truncation
+
+#define MAGNUS_A_HPA 6.112
+#define MAGNUS_B 17.62
+#define MAGNUS_C_DEGC 243.12
+#define AH_FACTOR 216.7
+
+#if CONFIG_PSYCHRO_TABLES
+#define BENCH_IMPLEMENTATION "tables"
+#else
+#define BENCH_IMPLEMENTATION "logf/expf"
+#endif
+
+static int32_t temperature[BENCH_SAMPLES];
+static int32_t humidity[BENCH_SAMPLES];
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double ref_dew_point(const double t, const double rh) {
+    const double gamma = log(rh / 100) + MAGNUS_B * t / (MAGNUS_C_DEGC + t);
+    return MAGNUS_C_DEGC * gamma / (MAGNUS_B - gamma);
+}
+
+static double ref_abs_humidity(const double t, const double rh) {
+    return rh / 100 * AH_FACTOR * MAGNUS_A_HPA * exp(MAGNUS_B * t / (MAGNUS_C_DEGC + t)) / (273.15 + t);
+}
+
+/**
+ * @brief Compares the fixed-point functions with the double precision reference over the whole input range.
+ */
+static int check_accuracy(void) {
+    int32_t worst_dew_point = 0, worst_t = 0, worst_rh = 0;
+    double worst_abs_humidity = 0;
+
+    for (int32_t t = -40000; t <= 120000; t += 100) {
+        for (int32_t rh = 1000; rh <= 100000; rh += 100) {
+            const int32_t dew_point_ref = (int32_t)lround(ref_dew_point(t / 1000.0, rh / 1000.0) * 1000);
+            const int32_t dew_point_error = abs(psychro_dew_point_milli(t, rh) - dew_point_ref);
+            if (dew_point_error > worst_dew_point) {
+                worst_dew_point = dew_point_error;
+                worst_t = t;
+                worst_rh = rh;
+            }
+
+            const double abs_humidity_ref = ref_abs_humidity(t / 1000.0, rh / 1000.0) * 1000;
+            const double abs_humidity_error =
+                (fabs(psychro_abs_humidity_milli(t, rh) - abs_humidity_ref) - 1) / abs_humidity_ref;
+            if (abs_humidity_error > worst_abs_humidity)
+                worst_abs_humidity = abs_humidity_error;
+        }
+    }
+
+    printf("%s, accuracy against the double precision Magnus formula, -40..120 degC, 1..100 %%RH\n",
+           BENCH_IMPLEMENTATION);
+    printf("\tdew point:         max error %d mdegC (%d mdegC, %d m%%RH)\n", worst_dew_point, worst_t, worst_rh);
+    printf("\tabsolute humidity: max error %.3f %% + 1 mg/m^3\n", worst_abs_humidity * 100);
+
+    return worst_dew_point > BENCH_MAX_DEW_POINT_ERROR_MILLI || worst_abs_humidity > BENCH_MAX_ABS_HUMIDITY_ERROR;
+}
+
+int main(void) {
+    volatile float sink_float = 0;
+    volatile int32_t sink_milli = 0;
+
+    if (check_accuracy() != 0) {
+        printf("accuracy check failed\n");
+        return 1;
+    }
+
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        temperature[i] = rand() % 160000 - 40000;
+        humidity[i] = rand() % 99000 + 1000;
+    }
+
+    double start = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++)
+            sink_milli = psychro_dew_point_milli(temperature[i], humidity[i]) +
+                         psychro_abs_humidity_milli(temperature[i], humidity[i]);
+    }
+    const double milli_s = now_s() - start;
+
+    start = now_s();
+    for (int r = 0; r < BENCH_ROUNDS; r++) {
+        for (int i = 0; i < BENCH_SAMPLES; i++) {
+            const float t = temperature[i] / 1000.0f, rh = humidity[i] / 1000.0f;
+            sink_float = psychro_dew_point(t, rh) + psychro_abs_humidity(t, rh);
+        }
+    }
+    const double float_s = now_s() - start;
+
+    const double samples = (double)BENCH_SAMPLES * BENCH_ROUNDS;
+    printf("%s, dew point and absolute humidity, %d x %d samples\n", BENCH_IMPLEMENTATION, BENCH_ROUNDS,
+           BENCH_SAMPLES);
+    printf("\tmilli-units: %8.1f Msamples/s\n", samples / milli_s * 1e-6);
+    printf("\tfloat:       %8.1f Msamples/s\n", samples / float_s * 1e-6);
+    (void)sink_float;
+    (void)sink_milli;
+
+    return 0;
+}
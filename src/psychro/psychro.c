@@ -0,0 +1,133 @@
+#include "psychro.h"
+
+#define PSYCHRO_RH_MIN_MILLI 1000  // ln(RH) diverges at 0
+#define PSYCHRO_RH_MAX_MILLI 100000
+
+static int32_t psychro_clamp(const int32_t value, const int32_t min, const int32_t max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+#if CONFIG_PSYCHRO_TABLES
+#include "psychro_tables.h"
+
+#define PSYCHRO_T_STEP_MASK ((1 << PSYCHRO_T_STEP_SHIFT) - 1)
+
+/**
+ * @brief Natural logarithm of x > 0, Q16: ln(2^k * (1 + f)) = k * ln(2) + ln(1 + f), with ln(1 + f) interpolated.
+ */
+static int32_t psychro_ln_q16(const uint32_t x) {
+    const int k = 31 - __builtin_clz(x);
+    const uint32_t fraction = (x << (31 - k)) << 1;  // f, Q32
+    const uint32_t i = fraction >> (32 - PSYCHRO_LN_TABLE_BITS);
+    const uint32_t rem = (fraction >> (16 - PSYCHRO_LN_TABLE_BITS)) & 0xffff;
+    const int32_t step = psychro_ln_table[i + 1] - psychro_ln_table[i];
+
+    return k * PSYCHRO_LN2_Q16 + psychro_ln_table[i] + ((step * (int32_t)rem) >> 16);
+}
+
+/**
+ * @brief Interpolates a table of the temperature grid.
+ *
+ * @param table Table, with an entry past PSYCHRO_T_MAX_MILLI.
+ * @param offset Temperature above PSYCHRO_T_MIN_MILLI, at most PSYCHRO_T_MAX_MILLI - PSYCHRO_T_MIN_MILLI.
+ */
+static int64_t psychro_t_interpolate(const int32_t *table, const uint32_t offset) {
+    const uint32_t i = offset >> PSYCHRO_T_STEP_SHIFT;
+    const int64_t step = (int64_t)table[i + 1] - table[i];
+
+    return table[i] + ((step * (offset & PSYCHRO_T_STEP_MASK)) >> PSYCHRO_T_STEP_SHIFT);
+}
+
+int32_t psychro_dew_point_milli(const int32_t temperature, const int32_t humidity) {
+    const int32_t t = psychro_clamp(temperature, PSYCHRO_T_MIN_MILLI, PSYCHRO_T_MAX_MILLI);
+    const int32_t rh = psychro_clamp(humidity, PSYCHRO_RH_MIN_MILLI, PSYCHRO_RH_MAX_MILLI);
+
+    // ln(RH / 100 %) + b * T / (c + T): always below b over the clamped ranges
+    const int32_t gamma = psychro_ln_q16(rh) - PSYCHRO_LN_100000_Q16 +
+                          (int32_t)psychro_t_interpolate(psychro_magnus_table, t - PSYCHRO_T_MIN_MILLI);
+
+    return (int32_t)((int64_t)PSYCHRO_MAGNUS_C_MILLI * gamma / (PSYCHRO_MAGNUS_B_Q16 - gamma));
+}
+
+int32_t psychro_abs_humidity_milli(const int32_t temperature, const int32_t humidity) {
+    const int32_t t = psychro_clamp(temperature, PSYCHRO_T_MIN_MILLI, PSYCHRO_T_MAX_MILLI);
+    const int32_t rh = psychro_clamp(humidity, 0, PSYCHRO_RH_MAX_MILLI);
+    const uint64_t saturation = psychro_t_interpolate(psychro_ah_table, t - PSYCHRO_T_MIN_MILLI);
+    const uint32_t rh_q16 = (uint32_t)rh * 2048 / 3125;  // rh / 100000 milli-%RH, Q16
+
+    return (int32_t)((saturation * rh_q16) >> (16 + PSYCHRO_AH_UNIT_SHIFT));
+}
+
+#if !CONFIG_HTS221_FIXED_POINT
+float psychro_dew_point(const float temperature, const float humidity) {
+    return psychro_dew_point_milli((int32_t)(temperature * 1000.0f), (int32_t)(humidity * 1000.0f)) / 1000.0f;
+}
+
+float psychro_abs_humidity(const float temperature, const float humidity) {
+    return psychro_abs_humidity_milli((int32_t)(temperature * 1000.0f), (int32_t)(humidity * 1000.0f)) / 1000.0f;
+}
+#endif
+#else
+#include <math.h>
+
+// Magnus formula over water, Sonntag 1990 coefficients, as in scripts/gen_psychro_tables.py
+#define PSYCHRO_MAGNUS_A_HPA 6.112f
+#define PSYCHRO_MAGNUS_B 17.62f
+#define PSYCHRO_MAGNUS_C_DEGC 243.12f
+#define PSYCHRO_AH_FACTOR 216.7f  // g K / (m^3 hPa)
+
+#define PSYCHRO_T_MIN_MILLI (-40000)  // HTS221 operating range, as the grid of the tables
+#define PSYCHRO_T_MAX_MILLI 120000
+
+static float psychro_clampf(const float value, const float min, const float max) {
+    return value < min ? min : (value > max ? max : value);
+}
+
+/**
+ * @brief Dew point in degC, from a temperature and a relative humidity already clamped.
+ */
+static float psychro_magnus_dew_point(const float t, const float rh) {
+    const float gamma = logf(rh / 100.0f) + PSYCHRO_MAGNUS_B * t / (PSYCHRO_MAGNUS_C_DEGC + t);
+
+    return PSYCHRO_MAGNUS_C_DEGC * gamma / (PSYCHRO_MAGNUS_B - gamma);
+}
+
+/**
+ * @brief Absolute humidity in g/m^3, from a temperature and a relative humidity already clamped.
+ */
+static float psychro_magnus_abs_humidity(const float t, const float rh) {
+    const float saturation_hpa = PSYCHRO_MAGNUS_A_HPA * expf(PSYCHRO_MAGNUS_B * t / (PSYCHRO_MAGNUS_C_DEGC + t));
+
+    return rh / 100.0f * PSYCHRO_AH_FACTOR * saturation_hpa / (273.15f + t);
+}
+
+int32_t psychro_dew_point_milli(const int32_t temperature, const int32_t humidity) {
+    const int32_t t = psychro_clamp(temperature, PSYCHRO_T_MIN_MILLI, PSYCHRO_T_MAX_MILLI);
+    const int32_t rh = psychro_clamp(humidity, PSYCHRO_RH_MIN_MILLI, PSYCHRO_RH_MAX_MILLI);
+
+    return (int32_t)lroundf(psychro_magnus_dew_point(t / 1000.0f, rh / 1000.0f) * 1000.0f);
+}
+
+int32_t psychro_abs_humidity_milli(const int32_t temperature, const int32_t humidity) {
+    const int32_t t = psychro_clamp(temperature, PSYCHRO_T_MIN_MILLI, PSYCHRO_T_MAX_MILLI);
+    const int32_t rh = psychro_clamp(humidity, 0, PSYCHRO_RH_MAX_MILLI);
+
+    return (int32_t)(psychro_magnus_abs_humidity(t / 1000.0f, rh / 1000.0f) * 1000.0f);
+}
+
+#if !CONFIG_HTS221_FIXED_POINT
+float psychro_dew_point(const float temperature, const float humidity) {
+    const float t = psychro_clampf(temperature, PSYCHRO_T_MIN_MILLI / 1000.0f, PSYCHRO_T_MAX_MILLI / 1000.0f);
+    const float rh = psychro_clampf(humidity, PSYCHRO_RH_MIN_MILLI / 1000.0f, PSYCHRO_RH_MAX_MILLI / 1000.0f);
+
+    return psychro_magnus_dew_point(t, rh);
+}
+
+float psychro_abs_humidity(const float temperature, const float humidity) {
+    const float t = psychro_clampf(temperature, PSYCHRO_T_MIN_MILLI / 1000.0f, PSYCHRO_T_MAX_MILLI / 1000.0f);
+    const float rh = psychro_clampf(humidity, 0.0f, PSYCHRO_RH_MAX_MILLI / 1000.0f);
+
+    return psychro_magnus_abs_humidity(t, rh);
+}
+#endif
+#endif
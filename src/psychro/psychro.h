@@ -0,0 +1,49 @@
+#ifndef PSYCHRO_H
+#define PSYCHRO_H
+
+#include <stdint.h>
+
+/**
+ * @brief Dew point from the temperature and the relative humidity (Magnus formula over water).
+ *
+ * @details Computed with logf()/expf(), or with CONFIG_PSYCHRO_TABLES by interpolating the generated lookup tables,
+ * without libm. The temperature is clamped to -40..120 degC and the humidity to 1..100 %RH.
+ *
+ * @param temperature Temperature in milli-degC.
+ * @param humidity Relative humidity in milli-%RH.
+ * @return the dew point in milli-degC.
+ */
+int32_t psychro_dew_point_milli(const int32_t temperature, const int32_t humidity);
+
+/**
+ * @brief Absolute humidity from the temperature and the relative humidity.
+ *
+ * @details Same formula and clamping as psychro_dew_point_milli(), except that the humidity may go down to 0.
+ *
+ * @param temperature Temperature in milli-degC.
+ * @param humidity Relative humidity in milli-%RH.
+ * @return the absolute humidity in mg/m^3.
+ */
+int32_t psychro_abs_humidity_milli(const int32_t temperature, const int32_t humidity);
+
+#if !CONFIG_HTS221_FIXED_POINT
+/**
+ * @brief Dew point, for the float conversion output.
+ *
+ * @param temperature Temperature in degC.
+ * @param humidity Relative humidity in %RH.
+ * @return the dew point in degC.
+ */
+float psychro_dew_point(const float temperature, const float humidity);
+
+/**
+ * @brief Absolute humidity, for the float conversion output.
+ *
+ * @param temperature Temperature in degC.
+ * @param humidity Relative humidity in %RH.
+ * @return the absolute humidity in g/m^3.
+ */
+float psychro_abs_humidity(const float temperature, const float humidity);
+#endif
+
+#endif
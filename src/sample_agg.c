@@ -0,0 +1,158 @@
+#include "sample_agg.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @brief Median of the first len entries of a history, by insertion sort of a copy.
+ */
+static uint16_t sample_agg_median(const uint16_t *history, const size_t len) {
+    uint16_t sorted[CONFIG_SAMPLE_AGG_MEDIAN_SIZE];
+
+    for (size_t i = 0; i < len; i++) {
+        size_t j = i;
+        for (; j > 0 && sorted[j - 1] > history[i]; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = history[i];
+    }
+
+    return sorted[len / 2];
+}
+
+/**
+ * @brief Adds a filtered sample to the window statistics and to the EMA of a channel.
+ *
+ * @param channel Channel state.
+ * @param value Output of the median filter.
+ * @param count Samples in the window, including this one.
+ * @param first true for the first sample since boot, which starts the EMA.
+ */
+static void sample_agg_channel_add(struct sample_agg_channel *channel, const uint16_t value, const uint16_t count,
+                                   const bool first) {
+    const int32_t value_q16 = (int32_t)value << 16;
+
+    if (count == 1) {
+        channel->min = value;
+        channel->max = value;
+        channel->mean_q16 = value_q16;
+        channel->m2_q16 = 0;
+    } else {
+        channel->min = MIN(channel->min, value);
+        channel->max = MAX(channel->max, value);
+
+        // Welford: the mean moves by delta / count, M2 grows by the product of the deviations from the old and the new
+        // mean. Both have the sign of delta, so the product is never negative.
+        const int32_t delta = value_q16 - channel->mean_q16;
+        channel->mean_q16 += delta / count;
+        channel->m2_q16 += ((int64_t)delta * (value_q16 - channel->mean_q16)) >> 16;
+    }
+
+    if (first)
+        channel->ema_q16 = value_q16;
+    else
+        channel->ema_q16 += (value_q16 - channel->ema_q16) >> CONFIG_SAMPLE_AGG_EMA_SHIFT;
+}
+
+static void sample_agg_channel_stats(const struct sample_agg_channel *channel, const uint16_t count,
+                                     struct sample_agg_stats *stats) {
+    stats->min = channel->min;
+    stats->max = channel->max;
+    stats->mean_q16 = channel->mean_q16;
+    stats->variance_q8 = count > 1 ? (uint32_t)((channel->m2_q16 / (count - 1)) >> 8) : 0;
+    stats->ema_q16 = channel->ema_q16;
+}
+
+void sample_agg_init(struct sample_agg *agg) { memset(agg, 0, sizeof(*agg)); }
+
+bool sample_agg_add(struct sample_agg *agg, const struct sample *sample, struct sample_agg_record *record) {
+    struct sample_agg_sensor *sensor = &agg->sensors[sample->sensor];
+    const bool first = sensor->history_len == 0;
+
+    sensor->humidity.history[sensor->history_pos] = sample->humidity;
+    sensor->temperature.history[sensor->history_pos] = sample->temperature;
+    sensor->history_pos = (sensor->history_pos + 1) % CONFIG_SAMPLE_AGG_MEDIAN_SIZE;
+    if (sensor->history_len < CONFIG_SAMPLE_AGG_MEDIAN_SIZE)
+        sensor->history_len++;
+
+    if (sensor->count == 0)
+        sensor->start = sample->timestamp;
+    sensor->count++;
+
+    sample_agg_channel_add(&sensor->humidity, sample_agg_median(sensor->humidity.history, sensor->history_len),
+                           sensor->count, first);
+    sample_agg_channel_add(&sensor->temperature, sample_agg_median(sensor->temperature.history, sensor->history_len),
+                           sensor->count, first);
+
+    if (sensor->count < CONFIG_SAMPLE_AGG_WINDOW_SAMPLES)
+        return false;
+
+    record->start = sensor->start;
+    record->end = sample->timestamp;
+    record->count = sensor->count;
+    record->sensor = sample->sensor;
+    sample_agg_channel_stats(&sensor->humidity, sensor->count, &record->humidity);
+    sample_agg_channel_stats(&sensor->temperature, sensor->count, &record->temperature);
+    sensor->count = 0;
+
+    return true;
+}
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+static uint32_t sample_agg_sqrt(uint64_t x) {
+    uint64_t root = 0;
+    uint64_t bit = 1ULL << 62;
+
+    while (bit > x)
+        bit >>= 2;
+    while (bit != 0) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+/**
+ * @brief Same calibration line as hts221_calib_temperature_milli() and hts221_calib_humidity_milli(), for a Q16 raw
+ * value.
+ */
+static int32_t sample_agg_linear_milli(const int32_t x0_milli, const int16_t x0_out, const int32_t slope_q16,
+                                       const int32_t raw_q16) {
+    const int64_t delta = ((int64_t)raw_q16 - (int64_t)x0_out * 65536) * slope_q16;
+    return x0_milli + (int32_t)((delta + (1LL << 31)) >> 32);
+}
+
+static void sample_agg_channel_milli(const struct sample_agg_stats *stats, const int32_t x0_milli, const int16_t x0_out,
+                                     const int32_t slope_q16, struct sample_agg_milli *milli) {
+    milli->min = sample_agg_linear_milli(x0_milli, x0_out, slope_q16, (int32_t)stats->min << 16);
+    milli->max = sample_agg_linear_milli(x0_milli, x0_out, slope_q16, (int32_t)stats->max << 16);
+    milli->mean = sample_agg_linear_milli(x0_milli, x0_out, slope_q16, stats->mean_q16);
+    milli->ema = sample_agg_linear_milli(x0_milli, x0_out, slope_q16, stats->ema_q16);
+
+    // The standard deviation only scales with the slope: sqrt(variance in Q16) is in Q8
+    const uint64_t stddev_q8 = sample_agg_sqrt((uint64_t)stats->variance_q8 << 8);
+    milli->stddev = (int32_t)((stddev_q8 * (uint64_t)llabs(slope_q16) + (1ULL << 23)) >> 24);
+
+    // A negative slope swaps the extremes
+    if (milli->min > milli->max) {
+        const int32_t min = milli->max;
+        milli->max = milli->min;
+        milli->min = min;
+    }
+}
+
+void sample_agg_to_milli(const struct sample_agg_record *record, const struct Hts221_calibration_coeff *calibration,
+                         struct sample_agg_milli *humidity, struct sample_agg_milli *temperature) {
+    sample_agg_channel_milli(&record->humidity, calibration->rh0_milli, calibration->h0_out, calibration->rh_slope_q16,
+                             humidity);
+    sample_agg_channel_milli(&record->temperature, calibration->t0_milli, calibration->t0_out,
+                             calibration->t_slope_q16, temperature);
+}
@@ -0,0 +1,110 @@
+#ifndef SAMPLE_AGG_H
+#define SAMPLE_AGG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hts221/hts221.h"
+#include "sample_ring.h"
+
+BUILD_ASSERT(CONFIG_SAMPLE_AGG_MEDIAN_SIZE % 2 == 1, "CONFIG_SAMPLE_AGG_MEDIAN_SIZE must be odd");
+
+/**
+ * @brief Statistics of one channel over a window, in raw units (HUMIDITY_OUT or TEMP_OUT words).
+ */
+struct sample_agg_stats {
+    uint16_t min;
+    uint16_t max;
+    int32_t mean_q16;      // Q16
+    uint32_t variance_q8;  // sample variance, raw^2 in Q8
+    int32_t ema_q16;       // Q16, at the end of the window
+};
+
+/**
+ * @brief Aggregate record of one sensor, emitted once per window.
+ */
+struct sample_agg_record {
+    uint32_t start;  // timestamp of the first sample of the window
+    uint32_t end;    // timestamp of the last sample of the window
+    uint16_t count;
+    uint8_t sensor;  // index in hts221_devs[]
+    struct sample_agg_stats humidity;
+    struct sample_agg_stats temperature;
+};
+
+/**
+ * @brief Aggregate statistics of one channel, converted into milli-units.
+ */
+struct sample_agg_milli {
+    int32_t min;
+    int32_t max;
+    int32_t mean;
+    int32_t stddev;
+    int32_t ema;
+};
+
+/**
+ * @brief Streaming state of one channel of one sensor.
+ *
+ * @details Samples first go through a median-of-CONFIG_SAMPLE_AGG_MEDIAN_SIZE filter that rejects isolated spikes. The
+ * filtered samples update the window statistics (min, max, and Welford's running mean and variance) and an exponential
+ * moving average with alpha = 2^-CONFIG_SAMPLE_AGG_EMA_SHIFT. The median history and the EMA carry over from one window
+ * to the next.
+ */
+struct sample_agg_channel {
+    uint16_t history[CONFIG_SAMPLE_AGG_MEDIAN_SIZE];  // last raw samples, for the median filter
+    uint16_t min;
+    uint16_t max;
+    int32_t mean_q16;
+    uint64_t m2_q16;  // sum of the squared differences from the mean
+    int32_t ema_q16;
+};
+
+/**
+ * @brief Streaming state of one sensor.
+ */
+struct sample_agg_sensor {
+    struct sample_agg_channel humidity;
+    struct sample_agg_channel temperature;
+    uint32_t start;       // timestamp of the first sample of the window
+    uint16_t count;       // samples in the current window
+    uint8_t history_len;  // valid entries of the median histories
+    uint8_t history_pos;  // next entry of the median histories to overwrite
+};
+
+/**
+ * @brief Windowed aggregation of the samples of every sensor, in the sample consumer.
+ */
+struct sample_agg {
+    struct sample_agg_sensor sensors[HTS221_DEV_COUNT];
+};
+
+/**
+ * @brief Starts an empty window for every sensor.
+ *
+ * @param agg Aggregation state.
+ */
+void sample_agg_init(struct sample_agg *agg);
+
+/**
+ * @brief Adds one sample to the window of its sensor.
+ *
+ * @param agg Aggregation state.
+ * @param sample Sample to add.
+ * @param record Record of the window, written only when the sample completes it.
+ * @return true if the sample completes a window of CONFIG_SAMPLE_AGG_WINDOW_SAMPLES samples.
+ */
+bool sample_agg_add(struct sample_agg *agg, const struct sample *sample, struct sample_agg_record *record);
+
+/**
+ * @brief Converts the statistics of a record into milli-units with the calibration of its sensor.
+ *
+ * @param record Aggregate record.
+ * @param calibration Calibration coefficients of the sensor of the record.
+ * @param humidity Humidity statistics, in milli-%RH.
+ * @param temperature Temperature statistics, in milli-degC.
+ */
+void sample_agg_to_milli(const struct sample_agg_record *record, const struct Hts221_calibration_coeff *calibration,
+                         struct sample_agg_milli *humidity, struct sample_agg_milli *temperature);
+
+#endif
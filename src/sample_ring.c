@@ -0,0 +1,63 @@
+#include "sample_ring.h"
+
+#define SAMPLE_RING_MASK (CONFIG_SAMPLE_RING_SIZE - 1)
+
+bool sample_ring_put(struct sample_ring *ring, const struct sample *sample) {
+    const uint32_t head = (uint32_t)atomic_get(&ring->head);
+    const uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+
+    if (head - tail >= CONFIG_SAMPLE_RING_SIZE) {
+        atomic_inc(&ring->overflows);
+        return false;
+    }
+
+    ring->buffer[head & SAMPLE_RING_MASK] = *sample;
+
+    // atomic_set() is a full barrier: the consumer cannot see the new head before the sample
+    atomic_set(&ring->head, (atomic_val_t)(head + 1));
+
+#if CONFIG_SAMPLE_BATCH
+    const uint32_t count = head + 1 - tail;
+    if (count >= CONFIG_SAMPLE_BATCH_SIZE) {
+        k_timer_stop(&ring->batch_deadline);
+        k_sem_give(&ring->batch_ready);
+    } else if (count == 1) {
+        k_timer_start(&ring->batch_deadline, K_MSEC(CONFIG_SAMPLE_BATCH_MAX_LATENCY_MS), K_NO_WAIT);
+    }
+#endif
+
+    return true;
+}
+
+#if CONFIG_SAMPLE_BATCH
+void sample_ring_batch_expired(struct k_timer *timer) {
+    struct sample_ring *ring = CONTAINER_OF(timer, struct sample_ring, batch_deadline);
+    k_sem_give(&ring->batch_ready);
+}
+
+int sample_ring_wait_batch(struct sample_ring *ring, k_timeout_t timeout) {
+    return k_sem_take(&ring->batch_ready, timeout);
+}
+#endif
+
+size_t sample_ring_get_batch(struct sample_ring *ring, struct sample *samples, const size_t max_count) {
+    const uint32_t tail = (uint32_t)atomic_get(&ring->tail);
+    const uint32_t head = (uint32_t)atomic_get(&ring->head);
+    const size_t count = MIN(head - tail, max_count);
+
+    for (size_t i = 0; i < count; i++)
+        samples[i] = ring->buffer[(tail + i) & SAMPLE_RING_MASK];
+
+    // Release the slots only after the copy, so that the producer cannot overwrite them while they are read
+    atomic_set(&ring->tail, (atomic_val_t)(tail + count));
+
+    return count;
+}
+
+size_t sample_ring_count(struct sample_ring *ring) {
+    return (uint32_t)atomic_get(&ring->head) - (uint32_t)atomic_get(&ring->tail);
+}
+
+uint32_t sample_ring_stored(struct sample_ring *ring) { return (uint32_t)atomic_get(&ring->head); }
+
+uint32_t sample_ring_overflows(struct sample_ring *ring) { return (uint32_t)atomic_get(&ring->overflows); }
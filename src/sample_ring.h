@@ -0,0 +1,113 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @brief One HTS221 sample, as read from the sensor. 8 bytes.
+ */
+struct sample {
+    uint32_t timestamp;         // k_cycle_get_32() at the DRDY edge
+    uint32_t humidity : 10;     // raw HUMIDITY_OUT word
+    uint32_t temperature : 10;  // raw TEMP_OUT word
+    uint32_t sensor : 5;        // index in hts221_devs[]
+    uint32_t reserved : 7;
+};
+
+BUILD_ASSERT(sizeof(struct sample) == 8, "struct sample is expected to be packed in 8 bytes");
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_SAMPLE_RING_SIZE), "CONFIG_SAMPLE_RING_SIZE must be a power of two");
+#if CONFIG_SAMPLE_BATCH
+BUILD_ASSERT(CONFIG_SAMPLE_BATCH_SIZE <= CONFIG_SAMPLE_RING_SIZE, "A sample batch must fit in the sample ring");
+#endif
+
+/**
+ * @brief Single-producer single-consumer lock-free ring of samples.
+ *
+ * @details head is written only by the producer and tail only by the consumer. Both are free running counters: the
+ * number of stored samples is head - tail, also across the 32-bit wrap around. The producer never blocks: when the ring
+ * is full the new sample is dropped and counted in overflows.
+ *
+ * With CONFIG_SAMPLE_BATCH the producer also signals the consumer once per batch: when CONFIG_SAMPLE_BATCH_SIZE samples
+ * are stored, or CONFIG_SAMPLE_BATCH_MAX_LATENCY_MS after the first sample of the batch, whichever comes first.
+ */
+struct sample_ring {
+    struct sample buffer[CONFIG_SAMPLE_RING_SIZE];
+    atomic_t head;
+    atomic_t tail;
+    atomic_t overflows;
+#if CONFIG_SAMPLE_BATCH
+    struct k_sem batch_ready;
+    struct k_timer batch_deadline;
+#endif
+};
+
+#if CONFIG_SAMPLE_BATCH
+void sample_ring_batch_expired(struct k_timer *timer);
+
+#define SAMPLE_RING_DEFINE(name)                                                                     \
+    struct sample_ring name = {                                                                      \
+        .batch_ready = Z_SEM_INITIALIZER(name.batch_ready, 0, 1),                                    \
+        .batch_deadline = Z_TIMER_INITIALIZER(name.batch_deadline, sample_ring_batch_expired, NULL), \
+    }
+#else
+#define SAMPLE_RING_DEFINE(name) struct sample_ring name
+#endif
+
+/**
+ * @brief Stores one sample. To be called by the producer only.
+ *
+ * @param ring Sample ring.
+ * @param sample Sample to store.
+ * @return true if the sample is stored, false if the ring is full and the sample is dropped.
+ */
+bool sample_ring_put(struct sample_ring *ring, const struct sample *sample);
+
+/**
+ * @brief Moves up to max_count of the oldest samples out of the ring. To be called by the consumer only.
+ *
+ * @param ring Sample ring.
+ * @param samples Array that stores the samples.
+ * @param max_count Size of the samples array.
+ * @return the number of samples copied.
+ */
+size_t sample_ring_get_batch(struct sample_ring *ring, struct sample *samples, const size_t max_count);
+
+#if CONFIG_SAMPLE_BATCH
+/**
+ * @brief Waits until a batch of samples is ready. To be called by the consumer only.
+ *
+ * @details The ring may be empty on return when the deadline of a batch expires while the consumer is draining it.
+ *
+ * @param ring Sample ring.
+ * @param timeout Maximum time to wait.
+ * @return 0 if a batch is ready, -EAGAIN on timeout.
+ */
+int sample_ring_wait_batch(struct sample_ring *ring, k_timeout_t timeout);
+#endif
+
+/**
+ * @brief Returns the number of samples currently stored.
+ *
+ * @param ring Sample ring.
+ */
+size_t sample_ring_count(struct sample_ring *ring);
+
+/**
+ * @brief Returns the number of samples stored since boot, wrapping around at 2^32.
+ *
+ * @param ring Sample ring.
+ */
+uint32_t sample_ring_stored(struct sample_ring *ring);
+
+/**
+ * @brief Returns the number of samples dropped because the ring was full.
+ *
+ * @param ring Sample ring.
+ */
+uint32_t sample_ring_overflows(struct sample_ring *ring);
+
+#endif
@@ -0,0 +1,293 @@
+#include "sample_stream.h"
+
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include "hts221/hts221.h"
+#if CONFIG_TELEMETRY
+#include "telemetry/telemetry.h"
+#endif
+
+#define SAMPLE_STREAM_UART DT_CHOSEN(pcs_sample_stream_uart)
+#define SAMPLE_STREAM_HEADER_SIZE 3  // type, sequence
+#define SAMPLE_STREAM_CRC_SIZE 2
+#define SAMPLE_STREAM_CALIB_SIZE 20
+#define SAMPLE_STREAM_INFO_SIZE (SAMPLE_STREAM_HEADER_SIZE + 10 + HTS221_DEV_COUNT * SAMPLE_STREAM_CALIB_SIZE)
+#if CONFIG_TELEMETRY
+#define SAMPLE_STREAM_SAMPLES_SIZE \
+    (SAMPLE_STREAM_HEADER_SIZE + TELEMETRY_BATCH_SIZE_MAX(CONFIG_SAMPLE_STREAM_FRAME_SAMPLES))
+#else
+#define SAMPLE_STREAM_SAMPLES_SIZE (SAMPLE_STREAM_HEADER_SIZE + 1 + CONFIG_SAMPLE_STREAM_FRAME_SAMPLES * 8)
+#endif
+#define SAMPLE_STREAM_PAYLOAD_MAX (MAX(SAMPLE_STREAM_INFO_SIZE, SAMPLE_STREAM_SAMPLES_SIZE) + SAMPLE_STREAM_CRC_SIZE)
+// COBS adds one byte per started block of 254 bytes, then the delimiter
+#define SAMPLE_STREAM_FRAME_MAX (SAMPLE_STREAM_PAYLOAD_MAX + SAMPLE_STREAM_PAYLOAD_MAX / 254 + 2)
+
+BUILD_ASSERT(HTS221_DEV_COUNT <= 32, "Too many HTS221 for the 5-bit sensor field of the stream samples");
+
+/**
+ * @brief Encoded frame, ready for uart_tx(). The buffer must stay valid until the UART_TX_DONE event.
+ */
+struct sample_stream_frame {
+    uint8_t data[SAMPLE_STREAM_FRAME_MAX];
+    size_t len;
+};
+
+static const struct device *const sample_stream_uart = DEVICE_DT_GET(SAMPLE_STREAM_UART);
+static struct sample_stream_frame sample_stream_frames[2];
+static struct sample_stream_frame *sample_stream_tx;       // in flight
+static struct sample_stream_frame *sample_stream_pending;  // queued behind sample_stream_tx
+static struct k_spinlock sample_stream_lock;               // frame pointers and stats, shared with the UART callback
+static struct sample_stream_stats sample_stream_stats;
+static uint8_t sample_stream_payload[SAMPLE_STREAM_PAYLOAD_MAX];
+static uint16_t sample_stream_sequence;
+static uint32_t sample_stream_since_info = CONFIG_SAMPLE_STREAM_INFO_PERIOD;
+static bool sample_stream_async;
+
+/************
+ * Encoding *
+ ************/
+
+/**
+ * @brief COBS-encodes a buffer and appends the 0x00 delimiter.
+ *
+ * @return the length of the encoded frame, at most len + len / 254 + 2.
+ */
+static size_t sample_stream_cobs_encode(const uint8_t *in, const size_t len, uint8_t *out) {
+    size_t code_pos = 0;
+    size_t out_len = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+        if (in[i] != 0) {
+            out[out_len++] = in[i];
+            code++;
+        }
+        if (in[i] == 0 || code == 0xff) {
+            out[code_pos] = code;
+            code_pos = out_len++;
+            code = 1;
+        }
+    }
+    out[code_pos] = code;
+    out[out_len++] = 0;
+
+    return out_len;
+}
+
+static uint8_t *sample_stream_put_calibration(uint8_t *p, const struct Hts221_calibration_coeff *calibration) {
+    sys_put_le32(calibration->t0_milli, p);
+    sys_put_le32(calibration->t_slope_q16, p + 4);
+    sys_put_le16(calibration->t0_out, p + 8);
+    sys_put_le32(calibration->rh0_milli, p + 10);
+    sys_put_le32(calibration->rh_slope_q16, p + 14);
+    sys_put_le16(calibration->h0_out, p + 18);
+
+    return p + SAMPLE_STREAM_CALIB_SIZE;
+}
+
+/************
+ * Transfer *
+ ************/
+
+/**
+ * @brief Starts the DMA transfer of a frame. Called with sample_stream_lock held.
+ */
+static void sample_stream_start(struct sample_stream_frame *frame) {
+    const int err = uart_tx(sample_stream_uart, frame->data, frame->len, SYS_FOREVER_US);
+
+    if (err != 0) {
+        sample_stream_stats.errors++;
+        sample_stream_tx = NULL;
+        return;
+    }
+    sample_stream_tx = frame;
+}
+
+#if CONFIG_UART_ASYNC_API
+static void sample_stream_uart_cb(const struct device *dev, struct uart_event *evt, void *user_data) {
+    if (evt->type != UART_TX_DONE && evt->type != UART_TX_ABORTED)
+        return;
+
+    k_spinlock_key_t key = k_spin_lock(&sample_stream_lock);
+    if (evt->type == UART_TX_DONE) {
+        sample_stream_stats.frames++;
+        sample_stream_stats.bytes += evt->data.tx.len;
+    } else {
+        sample_stream_stats.errors++;
+    }
+
+    sample_stream_tx = NULL;
+    if (sample_stream_pending != NULL) {
+        struct sample_stream_frame *frame = sample_stream_pending;
+        sample_stream_pending = NULL;
+        sample_stream_start(frame);
+    }
+    k_spin_unlock(&sample_stream_lock, key);
+}
+#endif
+
+/**
+ * @brief Returns a frame buffer that is neither in flight nor queued, or NULL when both are busy.
+ *
+ * @details Only the sending thread fills and queues frames, so the buffer stays free until it queues it.
+ */
+static struct sample_stream_frame *sample_stream_free_frame(void) {
+    struct sample_stream_frame *frame = NULL;
+
+    k_spinlock_key_t key = k_spin_lock(&sample_stream_lock);
+    for (size_t i = 0; i < ARRAY_SIZE(sample_stream_frames) && frame == NULL; i++) {
+        if (&sample_stream_frames[i] != sample_stream_tx && &sample_stream_frames[i] != sample_stream_pending)
+            frame = &sample_stream_frames[i];
+    }
+    if (frame == NULL)
+        sample_stream_stats.drops++;
+    k_spin_unlock(&sample_stream_lock, key);
+
+    return frame;
+}
+
+static void sample_stream_poll_frame(const struct sample_stream_frame *frame) {
+    for (size_t i = 0; i < frame->len; i++)
+        uart_poll_out(sample_stream_uart, frame->data[i]);
+
+    k_spinlock_key_t key = k_spin_lock(&sample_stream_lock);
+    sample_stream_stats.frames++;
+    sample_stream_stats.bytes += frame->len;
+    k_spin_unlock(&sample_stream_lock, key);
+}
+
+/**
+ * @brief Completes the header of the payload, appends its CRC, and encodes and sends the frame.
+ *
+ * @param type Frame type.
+ * @param len Length of the payload, header included.
+ */
+static int sample_stream_send_payload(const enum sample_stream_type type, size_t len) {
+    struct sample_stream_frame *frame = sample_stream_free_frame();
+    int err = 0;
+
+    if (frame == NULL) {
+        sample_stream_sequence++;  // the host sees the drop as a sequence gap
+        return -ENOBUFS;
+    }
+
+    sample_stream_payload[0] = type;
+    sys_put_le16(sample_stream_sequence++, &sample_stream_payload[1]);
+    sys_put_le16(crc16_itu_t(0xffff, sample_stream_payload, len), &sample_stream_payload[len]);
+    len += SAMPLE_STREAM_CRC_SIZE;
+    frame->len = sample_stream_cobs_encode(sample_stream_payload, len, frame->data);
+
+    if (!sample_stream_async) {
+        sample_stream_poll_frame(frame);
+        return 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&sample_stream_lock);
+    if (sample_stream_tx == NULL) {
+        sample_stream_start(frame);
+        err = sample_stream_tx == NULL ? -EIO : 0;
+    } else {
+        sample_stream_pending = frame;
+    }
+    k_spin_unlock(&sample_stream_lock, key);
+
+    return err;
+}
+
+static int sample_stream_send_info(void) {
+    uint8_t *p = &sample_stream_payload[SAMPLE_STREAM_HEADER_SIZE];
+
+    *p++ = SAMPLE_STREAM_VERSION;
+    sys_put_le32(sys_clock_hw_cycles_per_sec(), p);
+    k_spinlock_key_t key = k_spin_lock(&sample_stream_lock);
+    sys_put_le32(sample_stream_stats.drops, p + 4);
+    k_spin_unlock(&sample_stream_lock, key);
+    p[8] = HTS221_DEV_COUNT;
+    p += 9;
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++)
+        p = sample_stream_put_calibration(p, &hts221_devs[i].calibration);
+
+    return sample_stream_send_payload(SAMPLE_STREAM_INFO, p - sample_stream_payload);
+}
+
+#if CONFIG_TELEMETRY
+/**
+ * @brief Encodes the samples into one telemetry message, straight into the payload buffer, and sends it.
+ */
+static int sample_stream_send_samples(const struct sample *samples, const size_t count) {
+    const enum telemetry_format format = IS_ENABLED(CONFIG_TELEMETRY_FORMAT_RAW) ? TELEMETRY_RAW : TELEMETRY_MILLI;
+    size_t len;
+
+    const int err = telemetry_encode(samples, count, format, &sample_stream_payload[SAMPLE_STREAM_HEADER_SIZE],
+                                     SAMPLE_STREAM_SAMPLES_SIZE - SAMPLE_STREAM_HEADER_SIZE, &len);
+    if (err != 0) {
+        sample_stream_sequence++;  // the host sees the lost samples as a sequence gap
+        return err;
+    }
+
+    return sample_stream_send_payload(SAMPLE_STREAM_TELEMETRY, SAMPLE_STREAM_HEADER_SIZE + len);
+}
+#else
+static int sample_stream_send_samples(const struct sample *samples, const size_t count) {
+    uint8_t *p = &sample_stream_payload[SAMPLE_STREAM_HEADER_SIZE];
+
+    *p++ = count;
+    for (size_t i = 0; i < count; i++, p += 8) {
+        sys_put_le32(samples[i].timestamp, p);
+        sys_put_le32(samples[i].humidity | samples[i].temperature << 10 | samples[i].sensor << 20, p + 4);
+    }
+
+    return sample_stream_send_payload(SAMPLE_STREAM_SAMPLES, p - sample_stream_payload);
+}
+#endif
+
+/*******
+ * API *
+ *******/
+
+int sample_stream_init(void) {
+    if (!device_is_ready(sample_stream_uart))
+        return -ENODEV;
+
+#if CONFIG_UART_ASYNC_API
+    const int err = uart_callback_set(sample_stream_uart, sample_stream_uart_cb, NULL);
+    if (err != 0 && err != -ENOSYS && err != -ENOTSUP)
+        return err;
+    sample_stream_async = err == 0;
+#endif
+
+    return 0;
+}
+
+int sample_stream_send(const struct sample *batch, const size_t count) {
+    int err = 0;
+
+    for (size_t i = 0; i < count; i += CONFIG_SAMPLE_STREAM_FRAME_SAMPLES) {
+        if (sample_stream_since_info >= CONFIG_SAMPLE_STREAM_INFO_PERIOD) {
+            const int info_err = sample_stream_send_info();
+            if (info_err == 0)
+                sample_stream_since_info = 0;
+            else
+                err = info_err;
+        }
+
+        const size_t n = MIN(count - i, CONFIG_SAMPLE_STREAM_FRAME_SAMPLES);
+        const int samples_err = sample_stream_send_samples(&batch[i], n);
+        if (samples_err != 0)
+            err = samples_err;
+        sample_stream_since_info++;
+    }
+
+    return err;
+}
+
+void sample_stream_get_stats(struct sample_stream_stats *stats) {
+    k_spinlock_key_t key = k_spin_lock(&sample_stream_lock);
+    *stats = sample_stream_stats;
+    k_spin_unlock(&sample_stream_lock, key);
+}
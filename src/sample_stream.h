@@ -0,0 +1,74 @@
+#ifndef SAMPLE_STREAM_H
+#define SAMPLE_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sample_ring.h"
+
+/*
+ * Binary stream of the HTS221 samples over the UART of the "pcs,sample-stream-uart" chosen node.
+ *
+ * Every frame is a payload followed by its CRC-16/CCITT-FALSE (crc16_itu_t() seeded with 0xffff, little-endian),
+ * COBS-encoded and terminated by a 0x00 delimiter. All payload fields are little-endian and start with:
+ *      u8 type, u16 sequence  (sequence counts all the frames, a gap means lost frames)
+ *
+ * SAMPLE_STREAM_INFO, before the first sample frame and then every CONFIG_SAMPLE_STREAM_INFO_PERIOD sample frames:
+ *      u8 version, u32 timestamp frequency (Hz), u32 frames dropped on the device, u8 sensor count,
+ *      per sensor: i32 t0_milli, i32 t_slope_q16, i16 t0_out, i32 rh0_milli, i32 rh_slope_q16, i16 h0_out
+ * SAMPLE_STREAM_SAMPLES:
+ *      u8 count, per sample: u32 timestamp (cycles), u32 humidity (bits 0-9), temperature (10-19), sensor (20-24)
+ * SAMPLE_STREAM_TELEMETRY, instead of SAMPLE_STREAM_SAMPLES with CONFIG_TELEMETRY:
+ *      CBOR telemetry-batch message (src/telemetry/telemetry.cddl) of up to CONFIG_SAMPLE_STREAM_FRAME_SAMPLES samples
+ *
+ * The raw words are converted on the host with the calibration of the info frame, like hts221_calib_*_milli().
+ * Frames are sent by uart_tx(), so the UARTE EasyDMA moves the bytes, with one frame queued behind the one in flight.
+ * With UARTs that have no async API (native_sim PTY), frames are sent with uart_poll_out() from the caller.
+ * scripts/sample_stream.py decodes the stream.
+ */
+
+#define SAMPLE_STREAM_VERSION 1
+
+enum sample_stream_type {
+    SAMPLE_STREAM_INFO = 1,
+    SAMPLE_STREAM_SAMPLES = 2,
+    SAMPLE_STREAM_TELEMETRY = 3,
+};
+
+/**
+ * @brief Counters of the stream since boot.
+ */
+struct sample_stream_stats {
+    uint32_t frames;  // frames sent
+    uint32_t bytes;   // encoded bytes sent, delimiters included
+    uint32_t drops;   // frames dropped because both frame buffers were busy
+    uint32_t errors;  // frames that failed or were aborted
+};
+
+/**
+ * @brief Sets up the stream UART, in async mode when its driver supports it.
+ *
+ * @return 0 on success, -ENODEV if the UART is not ready, otherwise a value from uart_callback_set().
+ */
+int sample_stream_init(void);
+
+/**
+ * @brief Sends a batch of samples, in frames of up to CONFIG_SAMPLE_STREAM_FRAME_SAMPLES samples.
+ *
+ * @details Returns as soon as the frames are queued, unless the UART has no async API. Not reentrant. With
+ * CONFIG_TELEMETRY, every frame carries the samples as one CBOR telemetry message.
+ *
+ * @param batch Samples taken from the sample ring.
+ * @param count Number of samples in the batch.
+ * @return 0 on success, -ENOBUFS if a frame was dropped, otherwise a value from uart_tx() or telemetry_encode().
+ */
+int sample_stream_send(const struct sample *batch, const size_t count);
+
+/**
+ * @brief Reads the counters of the stream.
+ *
+ * @param stats Counters to fill.
+ */
+void sample_stream_get_stats(struct sample_stream_stats *stats);
+
+#endif
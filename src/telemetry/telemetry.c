@@ -0,0 +1,54 @@
+#include "telemetry.h"
+
+#include <errno.h>
+#include <zcbor_encode.h>
+#include <zephyr/kernel.h>
+
+#include "hts221/hts221.h"
+
+#define TELEMETRY_BATCH_ITEMS 4   // version, format, base-ms, samples
+#define TELEMETRY_SAMPLE_ITEMS 4  // offset-ms, sensor, humidity, temperature
+#define TELEMETRY_NESTING 2       // telemetry-batch, samples: backups for the array headers of canonical encoding
+
+static bool telemetry_encode_sample(zcbor_state_t *state, const struct sample *sample, const int32_t offset_ms,
+                                    const enum telemetry_format format) {
+    int32_t humidity = sample->humidity;
+    int32_t temperature = sample->temperature;
+
+    if (format == TELEMETRY_MILLI) {
+        const struct Hts221_calibration_coeff *calibration = &hts221_devs[sample->sensor].calibration;
+        humidity = hts221_calib_humidity_milli(calibration, sample->humidity);
+        temperature = hts221_calib_temperature_milli(calibration, sample->temperature);
+    }
+
+    return zcbor_int32_put(state, offset_ms) && zcbor_uint32_put(state, sample->sensor) &&
+           zcbor_int32_put(state, humidity) && zcbor_int32_put(state, temperature);
+}
+
+int telemetry_encode(const struct sample *batch, const size_t count, const enum telemetry_format format,
+                     uint8_t *buffer, const size_t size, size_t *len) {
+    ZCBOR_STATE_E(state, TELEMETRY_NESTING, buffer, size, 1);
+
+    // Same conversion as the flash log, with a single reference point for the whole batch
+    const uint32_t now_cyc = k_cycle_get_32();
+    const int64_t now_ms = k_uptime_get();
+    int64_t last_ms = count > 0 ? now_ms - k_cyc_to_ms_floor32(now_cyc - batch[0].timestamp) : now_ms;
+
+    bool ok = zcbor_list_start_encode(state, TELEMETRY_BATCH_ITEMS) && zcbor_uint32_put(state, TELEMETRY_VERSION) &&
+              zcbor_uint32_put(state, format) && zcbor_uint64_put(state, (uint64_t)last_ms) &&
+              zcbor_list_start_encode(state, count * TELEMETRY_SAMPLE_ITEMS);
+
+    for (size_t i = 0; i < count && ok; i++) {
+        const int64_t sample_ms = now_ms - k_cyc_to_ms_floor32(now_cyc - batch[i].timestamp);
+        ok = telemetry_encode_sample(state, &batch[i], (int32_t)(sample_ms - last_ms), format);
+        last_ms = sample_ms;
+    }
+
+    ok = ok && zcbor_list_end_encode(state, count * TELEMETRY_SAMPLE_ITEMS) &&
+         zcbor_list_end_encode(state, TELEMETRY_BATCH_ITEMS);
+    if (!ok)
+        return zcbor_peek_error(state) == ZCBOR_ERR_NO_PAYLOAD ? -ENOMEM : -EINVAL;
+
+    *len = state->payload - buffer;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sample_ring.h"
+
+/*
+ * CBOR encoding of sample batches for upstream telemetry, with zcbor, following the telemetry-batch rule of
+ * telemetry.cddl. The batch shares one base timestamp and every sample only stores its offset from the previous one.
+ */
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_HEADER_MAX 20  // array and break, version, format, uint64 base-ms, samples array and break
+#define TELEMETRY_SAMPLE_MAX 17  // int32 offset-ms, sensor, 2 x int32 values
+
+/**
+ * @brief Size of a buffer that holds the encoding of a batch of n samples, whatever their values.
+ */
+#define TELEMETRY_BATCH_SIZE_MAX(n) (TELEMETRY_HEADER_MAX + (n) * TELEMETRY_SAMPLE_MAX)
+
+enum telemetry_format {
+    TELEMETRY_RAW = 0,    // raw HUMIDITY_OUT and TEMP_OUT words
+    TELEMETRY_MILLI = 1,  // milli-%RH and milli-degC, converted with the calibration of the sensor
+};
+
+/**
+ * @brief Encodes a batch of samples into one CBOR message.
+ *
+ * @details Encodes straight into the caller's buffer, without heap allocation. The sample timestamps are converted into
+ * uptime milliseconds, so the batch must be encoded shortly after it was taken from the sample ring.
+ *
+ * @param batch Samples taken from the sample ring.
+ * @param count Number of samples in the batch.
+ * @param format Format of the sample values.
+ * @param buffer Buffer that receives the message, TELEMETRY_BATCH_SIZE_MAX(count) bytes is always enough.
+ * @param size Size of the buffer.
+ * @param len Length of the message.
+ * @return 0 on success, -ENOMEM if the buffer is too small, -EINVAL for any other encoding error.
+ */
+int telemetry_encode(const struct sample *batch, const size_t count, const enum telemetry_format format,
+                     uint8_t *buffer, const size_t size, size_t *len);
+
+#endif
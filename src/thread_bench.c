@@ -0,0 +1,240 @@
+#include "thread_bench.h"
+
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#if CONFIG_BENCH_EXIT
+#include <posix_board_if.h>
+#endif
+
+#include "channels.h"
+#include "hts221/emul/hts221_emul.h"
+#include "hts221_recovery.h"
+
+#define BENCH_STARTUP_MS 500
+#define BENCH_PERIOD_MS 50
+#define BENCH_SAMPLE_TIMEOUT_MS 100
+#define BENCH_SAMPLES 100
+
+#if CONFIG_HTS221_ACQ_CONTINUOUS
+#define BENCH_STRESS_PERIOD_US 20000  // DRDY at 50 Hz, 4 times the fastest ODR
+#define BENCH_STRESS_MS 10000
+#define BENCH_STRESS_SETTLE_MS 10  // longer than a sample read, shorter than a conversion period
+
+#if !CONFIG_SAMPLE_BATCH
+BUILD_ASSERT(CONFIG_SAMPLE_LOG_PERIOD_MS * 1000 / BENCH_STRESS_PERIOD_US < CONFIG_SAMPLE_RING_SIZE,
+             "The sample ring must hold the DRDY stress samples of a whole sample log period");
+#endif
+
+/**
+ * @brief Drives DRDY faster than the ODR and checks that every conversion reaches the sample ring, without stalls.
+ *
+ * @details Every conversion must be read before the next one (the emulator counts a conversion overwritten before its
+ * read as a conversion without a read), every read sample must be stored in the sample ring, and no channel may drop a
+ * message. The run starts and ends with a settle time, so that no read is in flight when the counters are sampled.
+ */
+static int bench_drdy_stress(const struct emul *hts221_emul) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct hts221_emul_stats stats;
+
+    k_msleep(BENCH_STARTUP_MS);
+    hts221_emul_set_odr_period(hts221_emul, BENCH_STRESS_PERIOD_US);
+    k_msleep(BENCH_STRESS_SETTLE_MS);
+
+    hts221_emul_reset_stats(hts221_emul);
+    const uint32_t stored = sample_ring_stored(&sample_log_ring);
+    const uint32_t overflows = sample_ring_overflows(&sample_log_ring);
+    const uint32_t drdy_drops = msg_chan_drops(&drdy_chan);
+    const uint32_t status_drops = msg_chan_drops(&status_chan);
+
+    k_msleep(BENCH_STRESS_MS);
+    hts221_emul_set_odr_period(hts221_emul, 0);
+    k_msleep(BENCH_STRESS_SETTLE_MS);
+
+    hts221_emul_get_stats(hts221_emul, &stats);
+    const uint32_t stored_samples = sample_ring_stored(&sample_log_ring) - stored;
+    const uint32_t ring_overflows = sample_ring_overflows(&sample_log_ring) - overflows;
+    const uint32_t drdy_chan_drops = msg_chan_drops(&drdy_chan) - drdy_drops;
+    const uint32_t status_chan_drops = msg_chan_drops(&status_chan) - status_drops;
+    const uint32_t max_read_us = k_cyc_to_us_ceil32(stats.max_read_cyc);
+
+    LOG_INF("HTS221 DRDY stress: %u conversions at %u us, %u read, %u stored", stats.conversions,
+            BENCH_STRESS_PERIOD_US, stats.samples_read, stored_samples);
+    LOG_INF("\tdrops: %u sample ring, %u DRDY channel, %u status channel, max read latency = %u us", ring_overflows,
+            drdy_chan_drops, status_chan_drops, max_read_us);
+
+    const bool passed = stats.conversions > 0 && stats.samples_read == stats.conversions &&
+                        stored_samples == stats.samples_read && ring_overflows == 0 && drdy_chan_drops == 0 &&
+                        status_chan_drops == 0 && max_read_us < BENCH_STRESS_PERIOD_US;
+    if (!passed) {
+        LOG_ERR("HTS221 DRDY stress: samples lost or stalled.");
+        return 1;
+    }
+
+    return 0;
+}
+#endif
+
+#if CONFIG_HTS221_ACQ_ONE_SHOT
+static void bench_press(const struct gpio_dt_spec *button) {
+    gpio_emul_input_set(button->port, button->pin, 1);
+    gpio_emul_input_set(button->port, button->pin, 0);
+}
+
+#if CONFIG_HTS221_RECOVERY
+#define BENCH_FAULT_TRANSFERS 3
+// One-shot timeout (1 s), then the recovery backoff until the faults are exhausted
+#define BENCH_RESUME_BOUND_MS (1000 + 2 * CONFIG_HTS221_RECOVERY_MAX_BACKOFF_MS + BENCH_PERIOD_MS)
+
+static const struct {
+    enum hts221_emul_fault fault;
+    const char *name;
+} bench_faults[] = {
+    {HTS221_EMUL_FAULT_NACK, "NACK"},
+    {HTS221_EMUL_FAULT_TIMEOUT, "bus timeout"},
+    {HTS221_EMUL_FAULT_STUCK_DRDY, "stuck DRDY"},
+    {HTS221_EMUL_FAULT_BROWNOUT, "brown-out"},
+};
+
+/**
+ * @brief Injects a fault and presses the button periodically until the pipeline publishes a sample again.
+ *
+ * @return Time from the fault to the first sample published, or -ETIMEDOUT after BENCH_RESUME_BOUND_MS.
+ */
+static int bench_fault(const struct emul *hts221_emul, const struct gpio_dt_spec *button,
+                       const enum hts221_emul_fault fault) {
+    struct hts221_recovery_stats stats;
+
+    hts221_recovery_get_stats(0, &stats);
+    const uint32_t samples_before = stats.samples;
+    const int64_t start = k_uptime_get();
+
+    hts221_emul_inject_fault(hts221_emul, fault, BENCH_FAULT_TRANSFERS);
+    while (k_uptime_get() - start < BENCH_RESUME_BOUND_MS) {
+        bench_press(button);
+        k_msleep(BENCH_PERIOD_MS);
+
+        hts221_recovery_get_stats(0, &stats);
+        if (stats.samples != samples_before)
+            return k_uptime_get() - start;
+    }
+    hts221_emul_inject_fault(hts221_emul, HTS221_EMUL_FAULT_NONE, 0);
+
+    return -ETIMEDOUT;
+}
+
+/**
+ * @brief Checks that the pipeline resumes within BENCH_RESUME_BOUND_MS after every emulated fault.
+ *
+ * @return 0 if it did after every fault, 1 otherwise: with CONFIG_BENCH_EXIT, the exit status of native_sim.
+ */
+static int bench_faults_run(const struct emul *hts221_emul, const struct gpio_dt_spec *button) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct hts221_recovery_stats stats;
+    int failed = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_faults); i++) {
+        const int resume_ms = bench_fault(hts221_emul, button, bench_faults[i].fault);
+        if (resume_ms < 0) {
+            LOG_ERR("HTS221 bench: no sample %u ms after %s fault.", BENCH_RESUME_BOUND_MS, bench_faults[i].name);
+            failed = 1;
+            continue;
+        }
+        // The last button press can complete up to BENCH_PERIOD_MS after the bound
+        if (resume_ms > BENCH_RESUME_BOUND_MS) {
+            LOG_ERR("HTS221 bench: %s fault, sampling resumed in %d ms, above the %u ms bound.", bench_faults[i].name,
+                    resume_ms, BENCH_RESUME_BOUND_MS);
+            failed = 1;
+            continue;
+        }
+        LOG_INF("HTS221 bench: %s fault, sampling resumed in %d ms (bound %u ms)", bench_faults[i].name, resume_ms,
+                BENCH_RESUME_BOUND_MS);
+    }
+
+    hts221_recovery_get_stats(0, &stats);
+    LOG_INF("\trecovery: %u requests, %u attempts, %u recoveries", stats.requests, stats.attempts, stats.recoveries);
+
+    return failed;
+}
+#endif
+
+/**
+ * @brief Presses the button periodically and reports the latency and the bus usage of the one-shot samples.
+ */
+static int bench_one_shot(const struct emul *hts221_emul) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios);
+    struct hts221_emul_stats stats;
+    uint64_t latency_sum_us = 0;
+    uint32_t latency_max_us = 0;
+    uint32_t completed = 0;
+
+    /*
+     * native_sim does not advance the simulated time while code runs, so the latency below only accounts for the
+     * modelled conversion time and for the time the application spends sleeping or waiting on the kernel.
+     */
+    k_msleep(BENCH_STARTUP_MS);
+    hts221_emul_reset_stats(hts221_emul);
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        hts221_emul_get_stats(hts221_emul, &stats);
+        const uint32_t samples_before = stats.samples_read;
+
+        const uint32_t start = k_cycle_get_32();
+        bench_press(&button);
+
+        for (int waited_ms = 0; waited_ms < BENCH_SAMPLE_TIMEOUT_MS; waited_ms++) {
+            hts221_emul_get_stats(hts221_emul, &stats);
+            if (stats.samples_read != samples_before)
+                break;
+            k_msleep(1);
+        }
+
+        if (stats.samples_read != samples_before) {
+            const uint32_t latency_us = k_cyc_to_us_floor32(stats.last_read_cyc - start);
+            latency_sum_us += latency_us;
+            latency_max_us = MAX(latency_max_us, latency_us);
+            completed++;
+        }
+
+        k_msleep(BENCH_PERIOD_MS);
+    }
+
+    hts221_emul_get_stats(hts221_emul, &stats);
+    LOG_INF("HTS221 bench: %u/%u samples, %u conversions", completed, BENCH_SAMPLES, stats.conversions);
+    if (completed == 0)
+        return 1;
+
+    LOG_INF("\tlatency mean = %u us, max = %u us", (uint32_t)(latency_sum_us / completed), latency_max_us);
+    LOG_INF("\tI2C per sample: %u.%02u transfers, %u.%02u bytes", stats.transfers / completed,
+            (stats.transfers % completed) * 100 / completed, stats.bytes / completed,
+            (stats.bytes % completed) * 100 / completed);
+
+#if CONFIG_HTS221_RECOVERY
+    return bench_faults_run(hts221_emul, &button);
+#else
+    return 0;
+#endif
+}
+#endif
+
+int bench_thread() {
+    const struct emul *hts221_emul = EMUL_DT_GET(DT_NODELABEL(hts221));
+
+#if CONFIG_HTS221_ACQ_ONE_SHOT
+    const int failed = bench_one_shot(hts221_emul);
+#else
+    const int failed = bench_drdy_stress(hts221_emul);
+#endif
+
+#if CONFIG_BENCH_EXIT
+    // Flush the deferred log messages, then end the native_sim process with the bench result as exit status
+    LOG_PANIC();
+    posix_exit(failed);
+#endif
+
+    return failed;
+}
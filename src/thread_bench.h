@@ -0,0 +1,22 @@
+#ifndef THREAD_BENCH_H
+#define THREAD_BENCH_H
+
+#include "config_log.h"
+
+/**
+ * @brief Benchmarks and stress tests the HTS221 sampling through the emulator (native_sim only).
+ *
+ * @details In one-shot mode, drives the emulated button and reports HTS221 sample latency and bus usage. With
+ * CONFIG_HTS221_RECOVERY, it then injects bus and sensor faults through the emulator and checks that sampling resumes
+ * within a bounded time.
+ *
+ * In continuous mode, drives DRDY faster than the ODR and checks that no conversion is missed, that every sample
+ * reaches the sample ring and that no channel drops a message.
+ *
+ * With CONFIG_BENCH_EXIT, ends the native_sim process with the result as exit status instead of returning.
+ *
+ * @return 0 on success, 1 if no sample completed, sampling did not resume after a fault, or samples were lost.
+ */
+int bench_thread();
+
+#endif
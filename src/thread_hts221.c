@@ -1,85 +1,575 @@
 #include "thread_hts221.h"
 
+#include <stdlib.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/math_extras.h>
+#include <zephyr/sys/util.h>
+
+#include "adaptive_sched.h"
+#include "calib_cache.h"
+#include "channels.h"
 #include "config_log.h"
-#include "events.h"
-#include "hts221/hts221.h"
-
-extern struct k_event events;
+#include "hts221_recovery.h"
+#include "hts221_static_config.h"
+#include "hts221_stats.h"
+#include "timing_hist.h"
+
+#define HTS221_JITTER_BUCKET_US 100
+#define HTS221_LATENCY_BUCKET_US 50
+#define HTS221_ONE_SHOT_TIMEOUT_MS 1000
+#define HTS221_POWER_REPORT_MS (60 * 60 * 1000)
+#define HTS221_READY_TIMEOUT_MS 500
+#define HTS221_READY_POLL_MS 1
+#define HTS221_WATCHDOG_PERIODS 4  // continuous mode: ODR periods without samples before a sensor is recovered
 
 void button_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
-    k_event_post(&events, EVENT_HTS221_READ_ALL);
+    const struct command_msg msg = {.command = COMMAND_HTS221_READ_ALL};
+    msg_chan_pub(&command_chan, &msg);
+}
+
+#if CONFIG_HTS221_ADAPTIVE
+#define HTS221_SCHEDULE_PERIOD_MS CONFIG_HTS221_ADAPTIVE_MAX_PERIOD_MS
+#elif CONFIG_HTS221_ONE_SHOT_PERIOD_MS > 0
+#define HTS221_SCHEDULE_PERIOD_MS CONFIG_HTS221_ONE_SHOT_PERIOD_MS
+#endif
+
+#ifdef HTS221_SCHEDULE_PERIOD_MS
+static void hts221_schedule_expired(struct k_timer *timer) {
+    const struct command_msg msg = {.command = COMMAND_HTS221_READ_ALL};
+    msg_chan_pub(&command_chan, &msg);
+}
+
+static K_TIMER_DEFINE(hts221_schedule_timer, hts221_schedule_expired, NULL);
+#endif
+
+#if CONFIG_HTS221_ADAPTIVE
+static struct adaptive_sched hts221_adaptive;
+
+/**
+ * @brief Feeds a new sample to the adaptive scheduler and restarts the schedule timer when the period changes.
+ */
+static void hts221_adaptive_update(const size_t sensor, const int16_t temp_raw, const int16_t humidity_raw) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    const struct hts221_dev *hts221 = &hts221_devs[sensor];
+
+    if (!adaptive_sched_update(&hts221_adaptive, sensor, hts221_convert_temperature_milli(hts221, temp_raw),
+                               hts221_convert_humidity_milli(hts221, humidity_raw), k_uptime_get()))
+        return;
+
+    LOG_INF("HTS221 sampling period: %u ms", hts221_adaptive.period_ms);
+    k_timer_start(&hts221_schedule_timer, K_MSEC(hts221_adaptive.period_ms), K_MSEC(hts221_adaptive.period_ms));
+}
+#endif
+
+#if CONFIG_HTS221_ACQ_CONTINUOUS
+struct hts221_acq_timing {
+    struct timing_hist jitter;   // deviation of the DRDY interval from the nominal ODR period
+    struct timing_hist latency;  // DRDY edge to sample published
+    uint32_t last_drdy_cyc;
+    bool has_last_drdy;
+};
+
+static struct hts221_acq_timing hts221_timing[HTS221_DEV_COUNT];
+static struct hts221_acq_timing hts221_timing_report[HTS221_DEV_COUNT];
+static atomic_t hts221_timing_report_pending;
+
+static void hts221_timing_report_handler(struct k_work *work) {
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        if (!atomic_test_and_clear_bit(&hts221_timing_report_pending, i))
+            continue;
+        timing_hist_log(&hts221_timing_report[i].jitter, "HTS221 DRDY jitter");
+        timing_hist_log(&hts221_timing_report[i].latency, "HTS221 DRDY to sample latency");
+    }
+}
+
+static K_WORK_DEFINE(hts221_timing_report_work, hts221_timing_report_handler);
+
+static void hts221_timing_init(struct hts221_acq_timing *timing) {
+    timing_hist_init(&timing->jitter, HTS221_JITTER_BUCKET_US);
+    timing_hist_init(&timing->latency, HTS221_LATENCY_BUCKET_US);
+}
+
+/**
+ * @brief Adds the DRDY interval and the DRDY to sample latency of a published sample to the sensor histograms.
+ *
+ * @details May run in ISR context: histograms are handed over to the system work queue to be logged.
+ */
+static void hts221_timing_add(const struct drdy_msg *drdy) {
+    struct hts221_acq_timing *timing = &hts221_timing[drdy->sensor];
+    const uint32_t now = k_cycle_get_32();
+
+    if (timing->has_last_drdy) {
+        const int32_t interval_us = k_cyc_to_us_floor32(drdy->timestamp - timing->last_drdy_cyc);
+        timing_hist_add(&timing->jitter, abs(interval_us - HTS221_ACQ_PERIOD_US));
+    }
+    timing->last_drdy_cyc = drdy->timestamp;
+    timing->has_last_drdy = true;
+    timing_hist_add(&timing->latency, k_cyc_to_us_floor32(now - drdy->timestamp));
+
+    if (CONFIG_HTS221_JITTER_REPORT_SAMPLES == 0 || timing->latency.count < CONFIG_HTS221_JITTER_REPORT_SAMPLES)
+        return;
+
+    // The previous report of this sensor is still being logged: skip this one
+    if (!atomic_test_bit(&hts221_timing_report_pending, drdy->sensor)) {
+        hts221_timing_report[drdy->sensor] = *timing;
+        atomic_set_bit(&hts221_timing_report_pending, drdy->sensor);
+        k_work_submit(&hts221_timing_report_work);
+    }
+    hts221_timing_init(timing);
+}
+#endif
+
+/**
+ * @brief Pushes a sample read after a DRDY edge, or its read error, to the channels.
+ *
+ * @details Safe in ISR context: logging and recovery are left to hts221_publish_report().
+ */
+static int hts221_publish_sample(const struct drdy_msg *drdy, const int err, const int16_t temp_raw,
+                                 const int16_t humidity_raw) {
+    struct status_msg status = {.status = STATUS_SAMPLE_OK, .sensor = drdy->sensor};
+
+    if (err != 0) {
+        status.status = STATUS_I2C_ERROR;
+        msg_chan_pub(&status_chan, &status);
+        return err;
+    }
+#if CONFIG_HTS221_RECOVERY
+    hts221_recovery_sample(drdy->sensor);
+#endif
+
+    const struct sample sample = {
+        .timestamp = drdy->timestamp,
+        .humidity = humidity_raw,
+        .temperature = temp_raw,
+        .sensor = drdy->sensor,
+    };
+    if (sample_chan_pub(&sample_chan, &sample) != 0) {
+        status.status = STATUS_OVERFLOW;
+    } else {
+        hts221_stats_published(drdy->sensor);
+        if (IS_ENABLED(CONFIG_SAMPLE_BATCH))
+            return 0;  // the sample consumer reports successful samples once per batch
+    }
+    msg_chan_pub(&status_chan, &status);
+
+    return 0;
+}
+
+/**
+ * @brief Logs the outcome of a sample read and requests the recovery of the sensor on error. Thread context only.
+ */
+static void hts221_publish_report(const size_t sensor, const int err) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    if (err != 0) {
+        LOG_ERR("Error %d: failed to read HTS221 (I2C@%x) data.", err, hts221_devs[sensor].i2c.addr);
+#if CONFIG_HTS221_RECOVERY
+        hts221_recovery_request(sensor);
+#endif
+        return;
+    }
+
+    static bool first_sample = true;
+    if (first_sample) {
+        first_sample = false;
+        LOG_INF("HTS221 first sample %u ms after boot.", (uint32_t)k_uptime_get());
+    }
+}
+
+#if !CONFIG_HTS221_ACQ_ASYNC
+/**
+ * @brief Publishes a sample read after a DRDY edge, and its status.
+ */
+static int hts221_publish(const struct drdy_msg *drdy, const int err, const int16_t temp_raw,
+                          const int16_t humidity_raw) {
+    const int ret = hts221_publish_sample(drdy, err, temp_raw, humidity_raw);
+
+    hts221_publish_report(drdy->sensor, err);
+#if CONFIG_HTS221_ADAPTIVE
+    if (ret == 0)
+        hts221_adaptive_update(drdy->sensor, temp_raw, humidity_raw);
+#endif
+
+    return ret;
+}
+#endif
+
+#if CONFIG_HTS221_ACQ_ASYNC
+static atomic_t hts221_async_errors[HTS221_DEV_COUNT];       // last read error, 0 once reported
+static atomic_t hts221_async_first_sample = ATOMIC_INIT(-1);  // sensor of the first sample until reported, then -2
+
+/**
+ * @brief Reports the read errors and the first sample of the asynchronous acquisition, out of the I2C ISR.
+ */
+static void hts221_async_report_handler(struct k_work *work) {
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        const int err = atomic_set(&hts221_async_errors[i], 0);
+        if (err != 0)
+            hts221_publish_report(i, err);
+    }
+
+    const atomic_val_t first_sample = atomic_get(&hts221_async_first_sample);
+    if (first_sample >= 0) {
+        atomic_set(&hts221_async_first_sample, -2);
+        hts221_publish_report(first_sample, 0);
+    }
+}
+
+static K_WORK_DEFINE(hts221_async_report_work, hts221_async_report_handler);
+
+/**
+ * @brief Hands the errors and the first sample over to the system work queue, to be logged and to trigger the
+ * recovery. Other successful reads do not wake any thread.
+ */
+static void hts221_async_report(const size_t sensor, const int err) {
+    if (err != 0)
+        atomic_set(&hts221_async_errors[sensor], err);
+    else if (!atomic_cas(&hts221_async_first_sample, -1, sensor))
+        return;
+
+    k_work_submit(&hts221_async_report_work);
+}
+
+/**
+ * @brief Completion of the read started by the DRDY ISR: publishes the sample without waking any thread.
+ *
+ * @details Runs in the ISR of the I2C controller: only the ring push and the statistics happen here. The adaptive
+ * scheduler is one-shot only, so it never runs on this path.
+ */
+static void hts221_async_read_done(struct hts221_dev *dev, int result, int16_t temp_raw, int16_t humidity_raw,
+                                   void *user_data) {
+    const struct drdy_msg drdy = {.timestamp = POINTER_TO_UINT(user_data), .sensor = dev - hts221_devs};
+
+    hts221_stats_i2c_done(drdy.sensor);
+    if (hts221_publish_sample(&drdy, result, temp_raw, humidity_raw) == 0)
+        hts221_timing_add(&drdy);
+    hts221_async_report(drdy.sensor, result);
 }
 
 void hts221_drdy_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
-    k_event_post(&events, EVENT_HTS221_DATA_READY);
+    const uint32_t start = hts221_stats_now();
+    const uint32_t now = k_cycle_get_32();
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        if (hts221_devs[i].drdy.port == dev && (pins & BIT(hts221_devs[i].drdy.pin))) {
+#if CONFIG_HTS221_RECOVERY
+            if (hts221_recovery_pending(i))
+                continue;  // the recovery re-arms DRDY itself
+#endif
+            hts221_stats_drdy(i, start);
+            hts221_stats_i2c_start(i);
+            // -EBUSY: the previous sample is still on the bus, this one is lost and DRDY stays active
+            const int err = hts221_read_raw_async(&hts221_devs[i], hts221_async_read_done, UINT_TO_POINTER(now));
+            if (err != 0) {
+                const struct status_msg status = {.status = STATUS_I2C_ERROR, .sensor = i};
+                msg_chan_pub(&status_chan, &status);
+                if (err != -EBUSY)
+                    hts221_async_report(i, err);
+            }
+        }
+    }
+
+    hts221_stats_isr_exit(start);
 }
+#else
+void hts221_drdy_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
+    const uint32_t start = hts221_stats_now();
+    const uint32_t now = k_cycle_get_32();
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        if (hts221_devs[i].drdy.port == dev && (pins & BIT(hts221_devs[i].drdy.pin))) {
+#if CONFIG_HTS221_RECOVERY
+            if (hts221_recovery_pending(i))
+                continue;  // the recovery re-arms DRDY itself
+#endif
+            const struct drdy_msg msg = {.timestamp = now, .sensor = i};
+            hts221_stats_drdy(i, start);
+            msg_chan_pub(&drdy_chan, &msg);
+        }
+    }
+
+    hts221_stats_isr_exit(start);
+}
+#endif
+
+#if !CONFIG_HTS221_ACQ_ASYNC
+/**
+ * @brief Reads the raw data of the sensor that raised DRDY, publishes the sample and its status.
+ */
+static int hts221_acquire(const struct drdy_msg *drdy) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct hts221_dev *hts221 = &hts221_devs[drdy->sensor];
+    int16_t temp_raw, humidity_raw;
+
+    LOG_DBG("HTS221 (I2C@%x), read new data.", hts221->i2c.addr);
+    pm_device_runtime_get(hts221->i2c.bus);
+    hts221_stats_i2c_start(drdy->sensor);
+    const int err = hts221_read_raw(hts221, &temp_raw, &humidity_raw);
+    hts221_stats_i2c_done(drdy->sensor);
+    pm_device_runtime_put(hts221->i2c.bus);
+
+    return hts221_publish(drdy, err, temp_raw, humidity_raw);
+}
+#endif
+
+#if CONFIG_HTS221_ACQ_ONE_SHOT
+/**
+ * @brief Polls the sensors whose DRDY edge never arrived and publishes the samples they completed anyway.
+ *
+ * @return Bitmask of the sensors that still have no data.
+ */
+static uint32_t hts221_poll_pending(uint32_t pending) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    bool humidity_available, temp_available;
+    int16_t temp_raw, humidity_raw;
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        if (!(pending & BIT(i)))
+            continue;
+
+        pm_device_runtime_get(hts221_devs[i].i2c.bus);
+        const int err =
+            hts221_read_status_raw(&hts221_devs[i], &humidity_available, &temp_available, &temp_raw, &humidity_raw);
+        pm_device_runtime_put(hts221_devs[i].i2c.bus);
+        if (err != 0 || !humidity_available || !temp_available)
+            continue;
+
+        LOG_WRN("HTS221 (I2C@%x) DRDY edge missed, sample read by polling.", hts221_devs[i].i2c.addr);
+        const struct drdy_msg drdy = {.timestamp = k_cycle_get_32(), .sensor = i};
+        hts221_publish(&drdy, 0, temp_raw, humidity_raw);
+        pending &= ~BIT(i);
+    }
+
+    return pending;
+}
+
+#if CONFIG_HTS221_POWER_DOWN
+/**
+ * @brief Puts all the sensors back in power-down mode after a one-shot conversion.
+ */
+static void hts221_power_down_all(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+#if CONFIG_HTS221_RECOVERY
+        if (hts221_recovery_pending(i))
+            continue;
+#endif
+        pm_device_runtime_get(hts221_devs[i].i2c.bus);
+        const int err = hts221_disable(&hts221_devs[i]);
+        pm_device_runtime_put(hts221_devs[i].i2c.bus);
+        if (err != 0)
+            LOG_ERR("Error %d: failed to power down HTS221 (I2C@%x).", err, hts221_devs[i].i2c.addr);
+    }
+}
+
+/**
+ * @brief Logs the time spent by every sensor in active and power-down mode since the previous report.
+ */
+static void hts221_power_report(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    static uint64_t reported_active_ms[HTS221_DEV_COUNT], reported_idle_ms[HTS221_DEV_COUNT];
+    uint64_t active_ms, idle_ms;
+
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        hts221_read_power_stats(&hts221_devs[i], &active_ms, &idle_ms);
+        LOG_INF("HTS221 (I2C@%x) power: active = %u ms, power-down = %u ms", hts221_devs[i].i2c.addr,
+                (uint32_t)(active_ms - reported_active_ms[i]), (uint32_t)(idle_ms - reported_idle_ms[i]));
+        reported_active_ms[i] = active_ms;
+        reported_idle_ms[i] = idle_ms;
+    }
+}
+#endif
+
+/**
+ * @brief One-shot acquisition: every READ_ALL command triggers one conversion on all the sensors.
+ */
+static void hts221_loop_one_shot(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct command_msg command;
+    struct drdy_msg drdy;
+    int err;
+#if CONFIG_HTS221_POWER_DOWN
+    int64_t next_power_report = k_uptime_get() + HTS221_POWER_REPORT_MS;
+#endif
+
+    while (1) {  // ---------------------------------------------------------------------------------------------------
+        k_msgq_get(&hts221_command_msgq, &command, K_FOREVER);
+        if (command.command != COMMAND_HTS221_READ_ALL)
+            continue;
+
+        // DRDY only fires after a conversion started below: anything still queued belongs to a timed out conversion
+        k_msgq_purge(&hts221_drdy_msgq);
+
+        // Start all the conversions first, so that the sensors convert concurrently
+        uint32_t pending = 0;
+        for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+#if CONFIG_HTS221_RECOVERY
+            if (hts221_recovery_pending(i))
+                continue;
+#endif
+            pm_device_runtime_get(hts221_devs[i].i2c.bus);
+            err = IS_ENABLED(CONFIG_HTS221_POWER_DOWN) ? hts221_wake_one_shot(&hts221_devs[i])
+                                                       : hts221_trigger_one_shot(&hts221_devs[i]);
+            pm_device_runtime_put(hts221_devs[i].i2c.bus);
+            if (err != 0) {
+                LOG_ERR("Error %d: failed to start HTS221 (I2C@%x) one-shot conversion.", err, hts221_devs[i].i2c.addr);
+                const struct status_msg status = {.status = STATUS_I2C_ERROR, .sensor = i};
+                msg_chan_pub(&status_chan, &status);
+#if CONFIG_HTS221_RECOVERY
+                hts221_recovery_request(i);
+#endif
+                continue;
+            }
+            pending |= BIT(i);
+        }
+
+        const int64_t deadline = k_uptime_get() + HTS221_ONE_SHOT_TIMEOUT_MS;
+        while (pending != 0) {
+            const int64_t remaining_ms = deadline - k_uptime_get();
+            if (remaining_ms <= 0 || k_msgq_get(&hts221_drdy_msgq, &drdy, K_MSEC(remaining_ms)) != 0) {
+                pending = hts221_poll_pending(pending);
+                if (pending == 0)
+                    break;
+
+                LOG_ERR("Error: no HTS221 data before TIMEOUT (pending = 0x%x).", pending);
+                const struct status_msg status = {.status = STATUS_TIMEOUT,
+                                                  .sensor = u32_count_trailing_zeros(pending)};
+                msg_chan_pub(&status_chan, &status);
+#if CONFIG_HTS221_RECOVERY
+                for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+                    if (pending & BIT(i))
+                        hts221_recovery_request(i);
+                }
+#endif
+                break;
+            }
+
+            if (!(pending & BIT(drdy.sensor)))
+                continue;
+            pending &= ~BIT(drdy.sensor);
+
+            hts221_acquire(&drdy);
+        }
+
+#if CONFIG_HTS221_POWER_DOWN
+        hts221_power_down_all();
+
+        if (k_uptime_get() >= next_power_report) {
+            hts221_power_report();
+            next_power_report += HTS221_POWER_REPORT_MS;
+        }
+#endif
+    }
+}
+#endif
+
+#if CONFIG_HTS221_ACQ_CONTINUOUS && !CONFIG_HTS221_ACQ_ASYNC
+/**
+ * @brief Continuous acquisition: the sensors convert at HTS221_ACQ_ODR and every DRDY edge triggers a read.
+ *
+ * @details The interval between consecutive DRDY edges of each sensor is compared with the nominal ODR period and the
+ * absolute deviation is collected in a jitter histogram, together with the DRDY to sample latency.
+ */
+static void hts221_loop_continuous(void) {
+    struct drdy_msg drdy;
+
+    while (1) {  // ---------------------------------------------------------------------------------------------------
+        k_msgq_get(&hts221_drdy_msgq, &drdy, K_FOREVER);
+
+        if (hts221_acquire(&drdy) == 0)
+            hts221_timing_add(&drdy);
+    }
+}
+#endif
 
 int hts221_thread() {
     LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    BUILD_ASSERT(HTS221_DEV_COUNT > 0, "No HTS221 enabled in the devicetree");
+    BUILD_ASSERT(HTS221_DEV_COUNT <= 32, "Too many HTS221 for the pending bitmask and struct sample");
+
+    // HTS221, static because in asynchronous mode the callbacks outlive the thread
+    static struct gpio_callback hts221_drdy_cb_data[HTS221_DEV_COUNT];
+    //
+    int err;
 
+#if CONFIG_HTS221_ACQ_ONE_SHOT
     // Button
     const struct gpio_dt_spec button = GPIO_DT_SPEC_GET_OR(DT_ALIAS(sw0), gpios, {0});
     struct gpio_callback button_cb_data;
-    // HTS221
-    const struct i2c_dt_spec hts221_i2c = I2C_DT_SPEC_GET(DT_NODELABEL(hts221));
-    const struct gpio_dt_spec hts221_drdy = GPIO_DT_SPEC_GET(DT_NODELABEL(hts221), drdy_gpios);
-    struct gpio_callback hts221_drdy_cb_data;
-    //
-    int err;
-    float humidity, temperature;
-    uint32_t triggered_event;
 
     err = config_button(&button, &button_cb_data);
     if (err != 0)
         return err;
+#endif
 
-    /*
-     * Without a temporary sleep, the I2C is not configured correctly and the sensor does not respond.
-     * FIXME: investigate the reason for this beahaviour.
-     */
-    k_msleep(100);
+    hts221_stats_init();
+#if CONFIG_HTS221_RECOVERY
+    hts221_recovery_init();
+#endif
 
-    err = config_hts221(&hts221_i2c);
+#if CONFIG_HTS221_CALIB_CACHE
+    err = calib_cache_init();
     if (err != 0)
-        return err;
+        LOG_WRN("Error %d: HTS221 calibration cache not available.", err);
+#endif
 
-    err = config_hts221_int_pin(&hts221_drdy, &hts221_drdy_cb_data);
-    if (err != 0)
-        return err;
+#if CONFIG_HTS221_ACQ_CONTINUOUS
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++)
+        hts221_timing_init(&hts221_timing[i]);
+#endif
 
-    /*
-     * When the drdy_en pin is enable on the HTS221 sensor, it set active because some data is ready in the sensor's
-     * registers. The pin is set to inactive from the sensor only when both humidity and temperature are read.
-     *
-     * If the pin is not set inactive before calling 'k_event_wait', the app will not work properly.
-     */
-    hts221_read_all(&hts221_i2c, &temperature, &humidity);
+    for (size_t i = 0; i < HTS221_DEV_COUNT; i++) {
+        struct hts221_dev *hts221 = &hts221_devs[i];
+
+        err = wait_hts221_ready(hts221);
+        if (err != 0)
+            return err;
+
+        err = config_hts221(hts221);
+        if (err != 0)
+            return err;
+
+        err = config_hts221_int_pin(hts221, &hts221_drdy_cb_data[i]);
+        if (err != 0)
+            return err;
+
+        /*
+         * When the drdy_en pin is enable on the HTS221 sensor, it set active because some data is ready in the
+         * sensor's registers. The pin is set to inactive from the sensor only when both humidity and temperature are
+         * read.
+         *
+         * If the pin is not set inactive before waiting for DRDY, the app will not work properly.
+         */
+        int32_t unused_temperature, unused_humidity;
+        hts221_read_all_milli(hts221, &unused_temperature, &unused_humidity);
+    }
 
-    while (1) {  // ---------------------------------------------------------------------------------------------------
-        k_event_set_masked(&events, 0, EVENT_HTS221_READ_ALL | EVENT_HTS221_DATA_READY);  // Clear events before waiting
-        k_event_wait(&events, EVENT_HTS221_READ_ALL, false, K_FOREVER);
-        k_event_post(&events, EVENT_LED_BLINK);
+#if CONFIG_HTS221_ADAPTIVE
+    adaptive_sched_init(&hts221_adaptive);
+#endif
+#if CONFIG_HTS221_RECOVERY && CONFIG_HTS221_ACQ_CONTINUOUS
+    hts221_recovery_start_watchdog(HTS221_WATCHDOG_PERIODS * HTS221_ACQ_PERIOD_US / 1000);
+#endif
+    LOG_INF("HTS221 configured %u ms after boot.", (uint32_t)k_uptime_get());
+#if CONFIG_HTS221_CALIB_CACHE
+    calib_cache_verify_later();
+#endif
 
-        err = hts221_trigger_one_shot(&hts221_i2c);
-        if (err != 0) {
-            LOG_ERR("Error %d: failed to start HTS221 (I2C@%x) one-shot conversion.", err, hts221_i2c.addr);
-            continue;
-        }
+#ifdef HTS221_SCHEDULE_PERIOD_MS
+    k_timer_start(&hts221_schedule_timer, K_MSEC(HTS221_SCHEDULE_PERIOD_MS), K_MSEC(HTS221_SCHEDULE_PERIOD_MS));
+#endif
 
-        triggered_event = k_event_wait(&events, EVENT_HTS221_DATA_READY, false, K_MSEC(1000));
-        if (triggered_event == 0) {
-            LOG_ERR("Error %d: no HTS221 (I2C@%x) data before TIMEOUT.", triggered_event, hts221_i2c.addr);
-            continue;
-        }
+#if CONFIG_HTS221_ACQ_ASYNC
+    LOG_INF("HTS221 asynchronous acquisition started, the acquisition thread exits.");
+#elif CONFIG_HTS221_ACQ_CONTINUOUS
+    hts221_loop_continuous();
+#else
+    hts221_loop_one_shot();
+#endif
 
-        LOG_DBG("HTS221 (I2C@%x), read new data. Events = 0x%x", hts221_i2c.addr, events.events);
-        err = hts221_read_all(&hts221_i2c, &temperature, &humidity);
-        if (err != 0) {
-            LOG_ERR("Error %d: failed to read HTS221 (I2C@%x) data.", err, hts221_i2c.addr);
-            continue;
-        }
-        LOG_INF("HTS221 (I2C@%x), humidity = %f, temperature = %f", hts221_i2c.addr, humidity, temperature);
-    }
+    return 0;
 }
 
 int config_button(const struct gpio_dt_spec *button, struct gpio_callback *button_cb_data) {
@@ -108,10 +598,16 @@ int config_button(const struct gpio_dt_spec *button, struct gpio_callback *butto
     return 0;
 }
 
-int config_hts221_int_pin(const struct gpio_dt_spec *hts221_drdy, struct gpio_callback *hts221_drdy_cb_data) {
+int config_hts221_int_pin(struct hts221_dev *hts221, struct gpio_callback *hts221_drdy_cb_data) {
     LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    const struct gpio_dt_spec *hts221_drdy = &hts221->drdy;
     int err;
 
+    if (hts221_drdy->port == NULL || !device_is_ready(hts221_drdy->port)) {
+        LOG_ERR("HTS221 (I2C@%x) DRDY pin not available.", hts221->i2c.addr);
+        return 1;
+    }
+
     err = gpio_pin_configure_dt(hts221_drdy, GPIO_INPUT);
     if (err < 0) {
         LOG_ERR("Error during HTS221 DRDY pin configuration.");
@@ -129,59 +625,113 @@ int config_hts221_int_pin(const struct gpio_dt_spec *hts221_drdy, struct gpio_ca
     return 0;
 }
 
-int config_hts221(const struct i2c_dt_spec *hts221_i2c) {
+int wait_hts221_ready(struct hts221_dev *hts221) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    const int64_t deadline = k_uptime_get() + HTS221_READY_TIMEOUT_MS;
+    uint8_t who_am_i = 0;
+
+    // The bus and the sensor may still be booting: poll WHO_AM_I instead of sleeping a fixed time
+    while (!device_is_ready(hts221->i2c.bus) || hts221_read_whoami(hts221, &who_am_i) != 0 ||
+           who_am_i != HTS221_WHO_AM_I_VALUE) {
+        if (k_uptime_get() >= deadline) {
+            LOG_ERR("HTS221 (I2C@%x) not responding (WHO_AM_I = 0x%x).", hts221->i2c.addr, who_am_i);
+            return 1;
+        }
+        k_msleep(HTS221_READY_POLL_MS);
+    }
+    LOG_DBG("HTS221 (I2C@%x) ready after %u ms.", hts221->i2c.addr, (uint32_t)k_uptime_get());
+
+    return 0;
+}
+
+int config_hts221(struct hts221_dev *hts221) {
     LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
 
-    if (!device_is_ready(hts221_i2c->bus)) {
-        LOG_ERR("I2C bus %s is not ready!\n\r", hts221_i2c->bus->name);
+    if (!device_is_ready(hts221->i2c.bus)) {
+        LOG_ERR("I2C bus %s is not ready!\n\r", hts221->i2c.bus->name);
         return 1;
     }
 
-    int err = hts221_set_av_conf(hts221_i2c, HTS221_AVG_CONFIG_2, HTS221_AVG_CONFIG_2);
+    int err;
+#if CONFIG_HTS221_CALIB_CACHE
+    if (calib_cache_load(hts221) == 0) {
+        LOG_INF("HTS221 (I2C@%x) conversion coefficients loaded from the cache.", hts221->i2c.addr);
+    } else {
+        err = calib_cache_refresh(hts221);
+        if (err != 0) {
+            LOG_DBG("Failed to read HTS221 (I2C@%x) conversion coefficients.", hts221->i2c.addr);
+            return 1;
+        }
+        LOG_INF("HTS221 (I2C@%x) conversion coefficients read correctly.", hts221->i2c.addr);
+    }
+#else
+    err = hts221_read_calibration(hts221);
     if (err != 0) {
-        LOG_DBG("Failed to write HTS221 (I2C@%x) avg configuration.", hts221_i2c->addr);
+        LOG_DBG("Failed to read HTS221 (I2C@%x) conversion coefficients.", hts221->i2c.addr);
         return 1;
     }
+    LOG_INF("HTS221 (I2C@%x) conversion coefficients read correctly.", hts221->i2c.addr);
+#endif
+
+    const uint32_t config_transfers = hts221->stats.transfers;
+    const uint32_t config_start = k_cycle_get_32();
 
-    err = hts221_set_odr(hts221_i2c, HTS221_ODR_ONE_SHOT);
+#if CONFIG_HTS221_STATIC_CONFIG
+    err = hts221_static_config_apply(hts221);
+    if (err != 0) {
+        LOG_DBG("Failed to write HTS221 (I2C@%x) configuration image.", hts221->i2c.addr);
+        return 1;
+    }
+#else
+    err = hts221_sync_shadow_regs(hts221);
     if (err != 0) {
-        LOG_DBG("Failed to set ODR config in HTS221 (I2C@%x).", hts221_i2c->addr);
+        LOG_DBG("Failed to read HTS221 (I2C@%x) configuration registers.", hts221->i2c.addr);
         return 1;
     }
 
-    err = hts221_set_bdu(hts221_i2c, false);
+    err = hts221_set_av_conf(hts221, HTS221_AVG_CONFIG_2, HTS221_AVG_CONFIG_2);
     if (err != 0) {
-        LOG_DBG("Failed to set BDU config in HTS221 (I2C@%x).", hts221_i2c->addr);
+        LOG_DBG("Failed to write HTS221 (I2C@%x) avg configuration.", hts221->i2c.addr);
         return 1;
     }
 
-    err = hts221_enable_data_ready(hts221_i2c, true);
+    err = hts221_set_odr(hts221, HTS221_ACQ_ODR);
     if (err != 0) {
-        LOG_DBG("Failed to enable DATA READY config in HTS221 (I2C@%x).", hts221_i2c->addr);
+        LOG_DBG("Failed to set ODR config in HTS221 (I2C@%x).", hts221->i2c.addr);
         return 1;
     }
 
-    err = hts221_read_calibration(hts221_i2c);
+    err = hts221_set_bdu(hts221, false);
     if (err != 0) {
-        LOG_DBG("Failed to read HTS221 (I2C@%x) conversion coefficients.", hts221_i2c->addr);
+        LOG_DBG("Failed to set BDU config in HTS221 (I2C@%x).", hts221->i2c.addr);
         return 1;
     }
-    LOG_INF("HTS221 (I2C@%x) conversion coefficients read correctly.", hts221_i2c->addr);
 
-    err = hts221_enable(hts221_i2c);
+    err = hts221_enable_data_ready(hts221, true);
     if (err != 0) {
-        LOG_DBG("Failed to activate HTS221 (I2C@%x).", hts221_i2c->addr);
+        LOG_DBG("Failed to enable DATA READY config in HTS221 (I2C@%x).", hts221->i2c.addr);
         return 1;
     }
 
+    // With CONFIG_HTS221_POWER_DOWN the sensor stays in power-down mode until the first one-shot
+    err = IS_ENABLED(CONFIG_HTS221_POWER_DOWN) ? hts221_disable(hts221) : hts221_enable(hts221);
+    if (err != 0) {
+        LOG_DBG("Failed to activate HTS221 (I2C@%x).", hts221->i2c.addr);
+        return 1;
+    }
+#endif
+
+    LOG_INF("HTS221 (I2C@%x) registers configured with %u transfers in %u us.", hts221->i2c.addr,
+            hts221->stats.transfers - config_transfers, k_cyc_to_us_floor32(k_cycle_get_32() - config_start));
+
 #if DEBUG
     uint8_t av_conf_reg, ctrl_reg1, ctrl_reg2, ctrl_reg3, status_reg;
-    err = hts221_read_all_conf_reg(hts221_i2c, &av_conf_reg, &ctrl_reg1, &ctrl_reg2, &ctrl_reg3, &status_reg);
+    err = hts221_read_all_conf_reg(hts221, &av_conf_reg, &ctrl_reg1, &ctrl_reg2, &ctrl_reg3, &status_reg);
     if (err != 0) {
-        LOG_DBG("Failed to read HTS221 (I2C@%x) config registers.", hts221_i2c->addr);
+        LOG_DBG("Failed to read HTS221 (I2C@%x) config registers.", hts221->i2c.addr);
         return 1;
     }
-    LOG_INF("HTS221 (I2C@%x) configuration registers:", hts221_i2c->addr);
+    LOG_INF("HTS221 (I2C@%x) configuration registers:", hts221->i2c.addr);
     LOG_INF("\tav_conf    = 0x%x", av_conf_reg);
     LOG_INF("\tctrl_reg1  = 0x%x", ctrl_reg1);
     LOG_INF("\tctrl_reg2  = 0x%x", ctrl_reg2);
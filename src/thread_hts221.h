@@ -6,7 +6,21 @@
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
-extern struct k_event events;
+#include "hts221/hts221.h"
+
+// Output data rate of the sensors, from the acquisition mode and ODR choices
+#if CONFIG_HTS221_ACQ_ODR_1_HZ
+#define HTS221_ACQ_ODR HTS221_ODR_1_HZ
+#define HTS221_ACQ_PERIOD_US 1000000
+#elif CONFIG_HTS221_ACQ_ODR_7_HZ
+#define HTS221_ACQ_ODR HTS221_ODR_7_HZ
+#define HTS221_ACQ_PERIOD_US 142857
+#elif CONFIG_HTS221_ACQ_ODR_12_5_HZ
+#define HTS221_ACQ_ODR HTS221_ODR_12_5_HZ
+#define HTS221_ACQ_PERIOD_US 80000
+#else
+#define HTS221_ACQ_ODR HTS221_ODR_ONE_SHOT
+#endif
 
 /**
  * @brief Button ISR callback function.
@@ -19,7 +33,7 @@ void button_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pin
 void hts221_drdy_isr(const struct device *dev, struct gpio_callback *cb, uint32_t pins);
 
 /**
- * @brief Main entry point for the thread managing readings from the HTS221 sensor.
+ * @brief Main entry point for the thread managing readings from all the HTS221 sensors in the devicetree.
  */
 int hts221_thread();
 
@@ -31,11 +45,16 @@ int config_button(const struct gpio_dt_spec *button, struct gpio_callback *butto
 /**
  * @brief Configures HTS221 data ready pin and ISR callback.
  */
-int config_hts221_int_pin(const struct gpio_dt_spec *hts221_drdy, struct gpio_callback *hts221_drdy_cb_data);
+int config_hts221_int_pin(struct hts221_dev *hts221, struct gpio_callback *hts221_drdy_cb_data);
+
+/**
+ * @brief Waits until the I2C bus is ready and the HTS221 sensor answers with the expected WHO_AM_I value.
+ */
+int wait_hts221_ready(struct hts221_dev *hts221);
 
 /**
  * @brief Configures the HTS221 sensor.
  */
-int config_hts221(const struct i2c_dt_spec *hts221_i2c);
+int config_hts221(struct hts221_dev *hts221);
 
 #endif
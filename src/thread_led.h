@@ -1,8 +0,0 @@
-#ifndef THREAD_LED_H
-#define THREAD_LED_H
-
-#include "config_log.h"
-
-int blink_thread();
-
-#endif
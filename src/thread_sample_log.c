@@ -0,0 +1,420 @@
+#include "thread_sample_log.h"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#if CONFIG_SAMPLE_LOG_MEASURE_COST || (CONFIG_TELEMETRY_MEASURE_COST && CONFIG_TIMING_FUNCTIONS)
+#include <zephyr/timing/timing.h>
+#endif
+
+#include "channels.h"
+#include "flash_log.h"
+#include "hts221/hts221.h"
+#include "hts221_stats.h"
+#if CONFIG_PSYCHRO
+#include "psychro/psychro.h"
+#endif
+#if CONFIG_SAMPLE_AGG
+#include "sample_agg.h"
+#endif
+#if CONFIG_SAMPLE_STREAM
+#include "sample_stream.h"
+#endif
+#if CONFIG_TELEMETRY_MEASURE_COST
+#include "telemetry/telemetry.h"
+#endif
+
+#define SAMPLE_LOG_BATCH_SIZE 16
+#define SAMPLE_LOG_REPORT_SAMPLES 1000
+#define SAMPLE_LOG_MEASURE_CALLS 16
+#define SAMPLE_LOG_TEXT_LINE_MAX 96
+
+#if CONFIG_SAMPLE_AGG
+static struct sample_agg sample_log_agg;
+
+static void sample_log_record_line(const char *name, const struct sample_agg_milli *stats) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    LOG_INF("\t%s: mean = %d, stddev = %d, min = %d, max = %d, ema = %d", name, stats->mean, stats->stddev, stats->min,
+            stats->max, stats->ema);
+}
+
+/**
+ * @brief Adds a batch of samples to the aggregation windows and logs the records of the windows it completes.
+ */
+static void sample_log_batch(const struct sample *batch, const size_t count) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct sample_agg_record record;
+    struct sample_agg_milli humidity, temperature;
+
+    for (size_t i = 0; i < count; i++) {
+        if (!sample_agg_add(&sample_log_agg, &batch[i], &record))
+            continue;
+
+        const struct hts221_dev *hts221 = &hts221_devs[record.sensor];
+        sample_agg_to_milli(&record, &hts221->calibration, &humidity, &temperature);
+        LOG_INF("HTS221 (I2C@%x), %u samples in %u ms:", hts221->i2c.addr, record.count,
+                k_cyc_to_ms_floor32(record.end - record.start));
+        sample_log_record_line("humidity (m%RH)", &humidity);
+        sample_log_record_line("temperature (mdegC)", &temperature);
+#if CONFIG_PSYCHRO
+        LOG_INF("\tdew point = %d mdegC, absolute humidity = %d mg/m3",
+                psychro_dew_point_milli(temperature.mean, humidity.mean),
+                psychro_abs_humidity_milli(temperature.mean, humidity.mean));
+#endif
+    }
+}
+#elif CONFIG_HTS221_FIXED_POINT
+static void sample_log_line(const struct hts221_dev *hts221, const int32_t humidity, const int32_t temperature) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+#if CONFIG_PSYCHRO
+    LOG_INF("HTS221 (I2C@%x), humidity = %d m%%RH, temperature = %d mdegC, dew point = %d mdegC, absolute humidity = "
+            "%d mg/m3",
+            hts221->i2c.addr, humidity, temperature, psychro_dew_point_milli(temperature, humidity),
+            psychro_abs_humidity_milli(temperature, humidity));
+#else
+    LOG_INF("HTS221 (I2C@%x), humidity = %d m%%RH, temperature = %d mdegC", hts221->i2c.addr, humidity, temperature);
+#endif
+}
+
+/**
+ * @brief Converts a batch of samples with hts221_convert_batch(), one sensor at a time, and logs them.
+ */
+static void sample_log_batch(const struct sample *batch, const size_t count) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    int16_t temp_raw[SAMPLE_LOG_BATCH_SIZE], humidity_raw[SAMPLE_LOG_BATCH_SIZE];
+    int32_t temperature[SAMPLE_LOG_BATCH_SIZE], humidity[SAMPLE_LOG_BATCH_SIZE];
+    const struct hts221_raw_batch raw = {.temp_raw = temp_raw, .humidity_raw = humidity_raw};
+    struct hts221_milli_batch milli = {.temperature = temperature, .humidity = humidity};
+
+    for (size_t sensor = 0; sensor < HTS221_DEV_COUNT; sensor++) {
+        const struct hts221_dev *hts221 = &hts221_devs[sensor];
+        size_t n = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            if (batch[i].sensor != sensor)
+                continue;
+            temp_raw[n] = batch[i].temperature;
+            humidity_raw[n] = batch[i].humidity;
+            n++;
+        }
+
+        const uint32_t start = hts221_stats_now();
+        hts221_convert_batch(&hts221->calibration, &raw, n, &milli);
+        hts221_stats_converted(start);
+        for (size_t i = 0; i < n; i++)
+            sample_log_line(hts221, humidity[i], temperature[i]);
+    }
+}
+#else
+static void sample_log_line(const struct hts221_dev *hts221, const float humidity, const float temperature) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+#if CONFIG_PSYCHRO
+    LOG_INF("HTS221 (I2C@%x), humidity = %f, temperature = %f, dew point = %f, absolute humidity = %f",
+            hts221->i2c.addr, (double)humidity, (double)temperature, (double)psychro_dew_point(temperature, humidity),
+            (double)psychro_abs_humidity(temperature, humidity));
+#else
+    LOG_INF("HTS221 (I2C@%x), humidity = %f, temperature = %f", hts221->i2c.addr, (double)humidity,
+            (double)temperature);
+#endif
+}
+
+static void sample_log_batch(const struct sample *batch, const size_t count) {
+    float temperature[SAMPLE_LOG_BATCH_SIZE], humidity[SAMPLE_LOG_BATCH_SIZE];
+
+    const uint32_t start = hts221_stats_now();
+    for (size_t i = 0; i < count; i++) {
+        const struct hts221_dev *hts221 = &hts221_devs[batch[i].sensor];
+        humidity[i] = hts221_convert_humidity(hts221, batch[i].humidity);
+        temperature[i] = hts221_convert_temperature(hts221, batch[i].temperature);
+    }
+    hts221_stats_converted(start);
+
+    for (size_t i = 0; i < count; i++)
+        sample_log_line(&hts221_devs[batch[i].sensor], humidity[i], temperature[i]);
+}
+#endif
+
+#if CONFIG_SAMPLE_LOG_MEASURE_COST
+/**
+ * @brief Measures the cycles spent in the caller by the LOG_INF of a sample line and logs the mean over a few calls.
+ *
+ * In immediate mode the message is formatted and output before LOG_INF returns, in deferred mode it is only packaged.
+ */
+static void sample_log_measure_cost(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    timing_init();
+    timing_start();
+
+    timing_t start = timing_counter_get();
+    for (uint32_t i = 0; i < SAMPLE_LOG_MEASURE_CALLS; i++)
+        sample_log_line(&hts221_devs[0], 0, 0);
+    timing_t end = timing_counter_get();
+
+    const uint64_t cycles = timing_cycles_get(&start, &end);
+    const uint64_t ns = timing_cycles_to_ns_avg(cycles, SAMPLE_LOG_MEASURE_CALLS);
+    timing_stop();
+
+    LOG_INF("Sample log line: %u cycles, %u ns per LOG_INF (%s mode)", (uint32_t)(cycles / SAMPLE_LOG_MEASURE_CALLS),
+            (uint32_t)ns, IS_ENABLED(CONFIG_LOG_MODE_DEFERRED) ? "deferred" : "immediate");
+}
+#endif
+
+#if CONFIG_TELEMETRY_MEASURE_COST
+/**
+ * @brief Size and encoding cost of the telemetry messages and of the text lines of the same samples, since the last
+ * report.
+ */
+struct sample_log_telemetry_cost {
+    uint32_t batches;
+    uint32_t samples;
+    uint32_t cbor_bytes;
+    uint32_t cbor_cycles;
+    uint32_t text_bytes;
+    uint32_t text_cycles;
+};
+
+static struct sample_log_telemetry_cost sample_log_telemetry;
+static uint8_t sample_log_telemetry_buffer[TELEMETRY_BATCH_SIZE_MAX(SAMPLE_LOG_BATCH_SIZE)];
+
+static uint32_t sample_log_cycles(void) {
+#if CONFIG_TIMING_FUNCTIONS
+    return (uint32_t)timing_counter_get();
+#else
+    return k_cycle_get_32();
+#endif
+}
+
+static void sample_log_init_telemetry(void) {
+#if CONFIG_TIMING_FUNCTIONS
+    timing_init();
+    timing_start();
+#endif
+}
+
+/**
+ * @brief Encodes a batch into a telemetry message, and formats the text log lines of the same samples to compare the
+ * sizes and the cycles spent.
+ *
+ * @details Measurement only: the sample stream encodes and sends the telemetry messages itself. The text lines are those
+ * of the fixed point sample log, without the prefix that the log backend adds. In immediate mode LOG_INF formats them
+ * the same way before returning.
+ */
+static void sample_log_telemetry_batch(const struct sample *batch, const size_t count) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    const enum telemetry_format format = IS_ENABLED(CONFIG_TELEMETRY_FORMAT_RAW) ? TELEMETRY_RAW : TELEMETRY_MILLI;
+    char line[SAMPLE_LOG_TEXT_LINE_MAX];
+    size_t len;
+
+    uint32_t start = sample_log_cycles();
+    const int err = telemetry_encode(batch, count, format, sample_log_telemetry_buffer,
+                                     sizeof(sample_log_telemetry_buffer), &len);
+    const uint32_t cbor_cycles = sample_log_cycles() - start;
+    if (err != 0) {
+        LOG_ERR("Error %d: failed to encode the telemetry batch.", err);
+        return;
+    }
+
+    uint32_t text_bytes = 0;
+    start = sample_log_cycles();
+    for (size_t i = 0; i < count; i++) {
+        const struct hts221_dev *hts221 = &hts221_devs[batch[i].sensor];
+        text_bytes += snprintk(line, sizeof(line), "HTS221 (I2C@%x), humidity = %d m%%RH, temperature = %d mdegC",
+                               hts221->i2c.addr, hts221_calib_humidity_milli(&hts221->calibration, batch[i].humidity),
+                               hts221_calib_temperature_milli(&hts221->calibration, batch[i].temperature));
+    }
+    const uint32_t text_cycles = sample_log_cycles() - start;
+
+    static bool dumped;
+    if (!dumped) {
+        LOG_HEXDUMP_INF(sample_log_telemetry_buffer, len, "First telemetry batch (CBOR):");
+        dumped = true;
+    }
+
+    sample_log_telemetry.batches++;
+    sample_log_telemetry.samples += count;
+    sample_log_telemetry.cbor_bytes += len;
+    sample_log_telemetry.cbor_cycles += cbor_cycles;
+    sample_log_telemetry.text_bytes += text_bytes;
+    sample_log_telemetry.text_cycles += text_cycles;
+}
+
+static void sample_log_report_telemetry(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    const struct sample_log_telemetry_cost *cost = &sample_log_telemetry;
+
+    if (cost->samples == 0)
+        return;
+
+    const uint32_t cbor_centi = cost->cbor_bytes * 100 / cost->samples;
+    const uint32_t text_centi = cost->text_bytes * 100 / cost->samples;
+    LOG_INF("Telemetry: %u samples in %u batches", cost->samples, cost->batches);
+    LOG_INF("\tCBOR: %u.%02u bytes per sample, %u cycles per batch", cbor_centi / 100, cbor_centi % 100,
+            cost->cbor_cycles / cost->batches);
+    LOG_INF("\ttext: %u.%02u bytes per sample, %u cycles per batch", text_centi / 100, text_centi % 100,
+            cost->text_cycles / cost->batches);
+    sample_log_telemetry = (struct sample_log_telemetry_cost){0};
+}
+#endif
+
+/**
+ * @brief Logs the wakeups of this thread per consumed sample and, when the scheduler tracks it, the CPU idle residency
+ * since the previous report.
+ */
+static void sample_log_report_wakeups(const uint32_t wakeups, const uint32_t samples) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    LOG_INF("Sample log: %u wakeups for %u samples, %u.%03u wakeups per sample", wakeups, samples, wakeups / samples,
+            (wakeups % samples) * 1000 / samples);
+
+#if CONFIG_SCHED_THREAD_USAGE_ALL
+    static k_thread_runtime_stats_t previous;
+    k_thread_runtime_stats_t stats;
+
+    if (k_thread_runtime_stats_all_get(&stats) != 0)
+        return;
+
+    const uint64_t cycles = stats.execution_cycles - previous.execution_cycles;
+    const uint64_t idle_cycles = stats.idle_cycles - previous.idle_cycles;
+    previous = stats;
+    if (cycles > 0)
+        LOG_INF("\tidle residency = %u.%02u %%", (uint32_t)(idle_cycles * 100 / cycles),
+                (uint32_t)(idle_cycles * 10000 / cycles % 100));
+#endif
+}
+
+#if CONFIG_SAMPLE_FLASH_LOG
+static int sample_log_count_flash(const struct flash_log_sample *sample, void *user_data) {
+    uint32_t *count = user_data;
+    (*count)++;
+    return 0;
+}
+
+/**
+ * @brief Opens the flash log and reports how many samples it holds.
+ *
+ * @return 0 on success, otherwise a value from flash_log_init(): the flash log must not be used.
+ */
+static int sample_log_init_flash(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    uint32_t count = 0;
+
+    int err = flash_log_init();
+    if (err != 0) {
+        LOG_ERR("Error %d: flash log not available.", err);
+        return err;
+    }
+
+    err = flash_log_walk(sample_log_count_flash, &count);
+    if (err != 0)
+        LOG_WRN("Error %d: failed to read the flash log.", err);
+    LOG_INF("Flash log: %u samples stored.", count);
+
+    return 0;
+}
+#endif
+
+#if CONFIG_SAMPLE_STREAM
+static void sample_log_report_stream(void) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+    struct sample_stream_stats stats;
+
+    sample_stream_get_stats(&stats);
+    LOG_INF("Sample stream: %u frames, %u bytes sent, %u frames dropped, %u failed", stats.frames, stats.bytes,
+            stats.drops, stats.errors);
+}
+#endif
+
+int sample_log_thread() {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    struct sample batch[SAMPLE_LOG_BATCH_SIZE];
+    uint32_t reported_overflows = 0;
+    uint32_t reported_drdy_drops = 0;
+    uint32_t wakeups = 0;
+    uint32_t samples = 0;
+    size_t count;
+
+#if CONFIG_SAMPLE_LOG_MEASURE_COST
+    sample_log_measure_cost();
+#endif
+#if CONFIG_SAMPLE_FLASH_LOG
+    const int flash_err = sample_log_init_flash();
+#endif
+#if CONFIG_SAMPLE_AGG
+    sample_agg_init(&sample_log_agg);
+#endif
+#if CONFIG_SAMPLE_STREAM
+    const int stream_err = sample_stream_init();
+    if (stream_err != 0)
+        LOG_ERR("Error %d: sample stream not available.", stream_err);
+#endif
+#if CONFIG_TELEMETRY_MEASURE_COST
+    sample_log_init_telemetry();
+#endif
+
+    while (1) {  // ---------------------------------------------------------------------------------------------------
+#if CONFIG_SAMPLE_BATCH
+        sample_ring_wait_batch(&sample_log_ring, K_FOREVER);
+#else
+        k_msleep(CONFIG_SAMPLE_LOG_PERIOD_MS);
+#endif
+        wakeups++;
+
+        size_t drained = 0;
+        while ((count = sample_ring_get_batch(&sample_log_ring, batch, ARRAY_SIZE(batch))) > 0) {
+            if (drained == 0)
+                hts221_stats_consumed();
+            sample_log_batch(batch, count);
+            drained += count;
+#if CONFIG_SAMPLE_STREAM
+            if (stream_err == 0)
+                sample_stream_send(batch, count);
+#endif
+#if CONFIG_TELEMETRY_MEASURE_COST
+            sample_log_telemetry_batch(batch, count);
+#endif
+#if CONFIG_SAMPLE_FLASH_LOG
+            for (size_t i = 0; i < count && flash_err == 0; i++) {
+                const int err = flash_log_add(&batch[i]);
+                if (err != 0)
+                    LOG_ERR("Error %d: failed to write the flash log.", err);
+            }
+#endif
+        }
+
+#if CONFIG_SAMPLE_BATCH
+        // HTS221 acquisition does not publish successful samples in batch mode: one LED blink per batch
+        if (drained > 0) {
+            const struct status_msg status = {.status = STATUS_SAMPLE_OK, .sensor = batch[0].sensor};
+            msg_chan_pub(&status_chan, &status);
+        }
+#endif
+
+        samples += drained;
+        if (samples >= SAMPLE_LOG_REPORT_SAMPLES) {
+            sample_log_report_wakeups(wakeups, samples);
+#if CONFIG_SAMPLE_STREAM
+            sample_log_report_stream();
+#endif
+#if CONFIG_TELEMETRY_MEASURE_COST
+            sample_log_report_telemetry();
+#endif
+            wakeups = 0;
+            samples = 0;
+        }
+
+        const uint32_t overflows = sample_ring_overflows(&sample_log_ring);
+        if (overflows != reported_overflows) {
+            LOG_WRN("%u HTS221 samples dropped, sample ring full.", overflows - reported_overflows);
+            reported_overflows = overflows;
+        }
+
+        const uint32_t drdy_drops = msg_chan_drops(&drdy_chan);
+        if (drdy_drops != reported_drdy_drops) {
+            LOG_WRN("%u HTS221 DRDY edges dropped, DRDY queue full.", drdy_drops - reported_drdy_drops);
+            reported_drdy_drops = drdy_drops;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,11 @@
+#ifndef THREAD_SAMPLE_LOG_H
+#define THREAD_SAMPLE_LOG_H
+
+#include "config_log.h"
+
+/**
+ * @brief Main entry point for the thread that drains the HTS221 sample ring and logs the samples.
+ */
+int sample_log_thread();
+
+#endif
@@ -0,0 +1,62 @@
+#include "timing_hist.h"
+
+#include <string.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include "config_log.h"
+
+void timing_hist_init(struct timing_hist *hist, const uint32_t bucket_us) {
+    memset(hist, 0, sizeof(*hist));
+    hist->bucket_us = bucket_us;
+    hist->min_us = UINT32_MAX;
+}
+
+void timing_hist_add(struct timing_hist *hist, const uint32_t value_us) {
+    const uint32_t bucket = MIN(value_us / hist->bucket_us, TIMING_HIST_BUCKETS - 1);
+
+    hist->buckets[bucket]++;
+    hist->count++;
+    hist->min_us = MIN(hist->min_us, value_us);
+    hist->max_us = MAX(hist->max_us, value_us);
+    hist->sum_us += value_us;
+}
+
+uint32_t timing_hist_percentile(const struct timing_hist *hist, const uint32_t percent) {
+    const uint32_t rank = DIV_ROUND_UP((uint64_t)hist->count * percent, 100);
+    uint32_t cumulative = 0;
+
+    if (hist->count == 0)
+        return 0;
+
+    for (uint32_t i = 0; i < TIMING_HIST_BUCKETS - 1; i++) {
+        cumulative += hist->buckets[i];
+        if (cumulative >= rank)
+            return MIN((i + 1) * hist->bucket_us - 1, hist->max_us);
+    }
+
+    return hist->max_us;
+}
+
+void timing_hist_log(const struct timing_hist *hist, const char *name) {
+    LOG_MODULE_DECLARE(pcs_weather, LOG_LEVEL);
+
+    if (hist->count == 0) {
+        LOG_INF("%s: no samples", name);
+        return;
+    }
+
+    LOG_INF("%s: n = %u, min = %u us, max = %u us, mean = %u us", name, hist->count, hist->min_us, hist->max_us,
+            (uint32_t)(hist->sum_us / hist->count));
+
+    for (uint32_t i = 0; i < TIMING_HIST_BUCKETS; i++) {
+        if (hist->buckets[i] == 0)
+            continue;
+
+        if (i == TIMING_HIST_BUCKETS - 1) {
+            LOG_INF("\t>= %6u us: %u", i * hist->bucket_us, hist->buckets[i]);
+        } else {
+            LOG_INF("\t%6u..%6u us: %u", i * hist->bucket_us, (i + 1) * hist->bucket_us - 1, hist->buckets[i]);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef TIMING_HIST_H
+#define TIMING_HIST_H
+
+#include <stdint.h>
+
+#define TIMING_HIST_BUCKETS 16  // the last bucket collects every value beyond the range
+
+struct timing_hist {
+    uint32_t bucket_us;
+    uint32_t buckets[TIMING_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+};
+
+/**
+ * @brief Clears the histogram and sets the bucket width.
+ *
+ * @param hist Histogram to initialize.
+ * @param bucket_us Width of each bucket in microseconds.
+ */
+void timing_hist_init(struct timing_hist *hist, const uint32_t bucket_us);
+
+/**
+ * @brief Adds one value to the histogram.
+ *
+ * @param hist Histogram to update.
+ * @param value_us Value in microseconds.
+ */
+void timing_hist_add(struct timing_hist *hist, const uint32_t value_us);
+
+/**
+ * @brief Estimates a percentile of the values added to the histogram.
+ *
+ * @param hist Histogram to read.
+ * @param percent Percentile, from 1 to 100.
+ * @return Upper bound of the bucket that holds the percentile, capped at the maximum value, or 0 when empty.
+ */
+uint32_t timing_hist_percentile(const struct timing_hist *hist, const uint32_t percent);
+
+/**
+ * @brief Logs count, min, max, mean and the non-empty buckets of the histogram.
+ *
+ * @param hist Histogram to log.
+ * @param name Name printed in front of the report.
+ */
+void timing_hist_log(const struct timing_hist *hist, const char *name);
+
+#endif